@@ -17,17 +17,27 @@
 */
 
 #include <assert.h>
+#include <inttypes.h>
 #include <stdint.h>
+#include <stdio.h>
 
-#ifdef USE_PEXT
+#if defined(USE_PEXT)
 #include <immintrin.h>
 #endif
 
 #include "attacks.h"
 #include "bitboards.h"
 #include "board.h"
+#include "cpu.h"
+#include "masks.h"
 #include "types.h"
 
+#if defined(USE_TABLES)
+
+#include "tables/attacks.h" // Generated ahead of time by ./Ethereal tablegen
+
+#else
+
 uint64_t PawnAttacks[COLOUR_NB][SQUARE_NB];
 uint64_t KnightAttacks[SQUARE_NB];
 uint64_t BishopAttacks[0x1480];
@@ -37,24 +47,126 @@ uint64_t KingAttacks[SQUARE_NB];
 Magic BishopTable[SQUARE_NB];
 Magic RookTable[SQUARE_NB];
 
+// Used by SLIDER_PDEP, where each attack set is stored as a uint16,
+// compressed onto the squares the slider sees on an empty board
+uint16_t BishopAttacks16[0x1480];
+uint16_t RookAttacks16[0x19000];
+uint64_t BishopRays[SQUARE_NB];
+uint64_t RookRays[SQUARE_NB];
+
+// Used by SLIDER_OBSTRUCTION, where each of the four lines through a
+// square is split into the squares below it, and the squares above it
+uint64_t LineMasks[4][SQUARE_NB][2];
+
+#endif
+
 static int validCoordinate(int rank, int file) {
     return 0 <= rank && rank < RANK_NB
         && 0 <= file && file < FILE_NB;
 }
 
+#if !defined(USE_TABLES)
+
 static void setSquare(uint64_t *bb, int rank, int file) {
     if (validCoordinate(rank, file))
         *bb |= 1ull << square(rank, file);
 }
 
-static int sliderIndex(uint64_t occupied, Magic *table) {
-#ifdef USE_PEXT
-    return _pext_u64(occupied, table->mask);
+#endif
+
+static uint64_t pext64(uint64_t bb, uint64_t mask) {
+#if defined(USE_PEXT)
+    return _pext_u64(bb, mask);
+#elif defined(__x86_64__)
+    return cpuPext(bb, mask);
+#else
+    (void) bb, (void) mask; return 0ull; // Never selected without BMI2
+#endif
+}
+
+static uint64_t pdep64(uint64_t bb, uint64_t mask) {
+#if defined(USE_PEXT)
+    return _pdep_u64(bb, mask);
+#elif defined(__x86_64__)
+    return cpuPdep(bb, mask);
 #else
+    (void) bb, (void) mask; return 0ull; // Never selected without BMI2
+#endif
+}
+
+static int magicIndex(uint64_t occupied, Magic *table) {
     return ((occupied & table->mask) * table->magic) >> table->shift;
+}
+
+#if !defined(USE_PDEP) && !defined(USE_OBSTRUCTION)
+
+static int sliderIndex(uint64_t occupied, Magic *table) {
+#if defined(USE_PEXT)
+    return pext64(occupied, table->mask);
+#elif defined(USE_DISPATCH)
+    return DispatchPEXT ? (int) pext64(occupied, table->mask) : magicIndex(occupied, table);
+#else
+    return magicIndex(occupied, table);
 #endif
 }
 
+#endif
+
+static uint64_t lineAttacks(uint64_t occupied, const uint64_t line[2]) {
+
+    // Obstruction Difference. The nearest blocker below the square is the
+    // most significant one in the lower half, and the nearest blocker above
+    // is the least significant one in the upper half. Adding twice the upper
+    // blocker to all bits from the lower blocker leaves only those in between
+    const uint64_t lower = line[0] & occupied;
+    const uint64_t upper = line[1] & occupied;
+    const uint64_t below = ~0ull << getmsb(lower | 1);
+    return (line[0] | line[1]) & (below + 2 * (upper & -upper));
+}
+
+/* Slider backends, for use by bishopAttacks(), rookAttacks(), and the microbenchmark */
+
+static uint64_t magicBishopAttacks(int sq, uint64_t occupied) {
+    return BishopTable[sq].offset[magicIndex(occupied, &BishopTable[sq])];
+}
+
+static uint64_t magicRookAttacks(int sq, uint64_t occupied) {
+    return RookTable[sq].offset[magicIndex(occupied, &RookTable[sq])];
+}
+
+static uint64_t pextBishopAttacks(int sq, uint64_t occupied) {
+    return BishopTable[sq].offset[pext64(occupied, BishopTable[sq].mask)];
+}
+
+static uint64_t pextRookAttacks(int sq, uint64_t occupied) {
+    return RookTable[sq].offset[pext64(occupied, RookTable[sq].mask)];
+}
+
+static uint64_t pdepBishopAttacks(int sq, uint64_t occupied) {
+    const uint16_t *attacks = &BishopAttacks16[BishopTable[sq].offset - BishopAttacks];
+    return pdep64(attacks[pext64(occupied, BishopTable[sq].mask)], BishopRays[sq]);
+}
+
+static uint64_t pdepRookAttacks(int sq, uint64_t occupied) {
+    const uint16_t *attacks = &RookAttacks16[RookTable[sq].offset - RookAttacks];
+    return pdep64(attacks[pext64(occupied, RookTable[sq].mask)], RookRays[sq]);
+}
+
+static uint64_t obstructionBishopAttacks(int sq, uint64_t occupied) {
+    return lineAttacks(occupied, LineMasks[2][sq]) | lineAttacks(occupied, LineMasks[3][sq]);
+}
+
+static uint64_t obstructionRookAttacks(int sq, uint64_t occupied) {
+    return lineAttacks(occupied, LineMasks[0][sq]) | lineAttacks(occupied, LineMasks[1][sq]);
+}
+
+const SliderBackend SliderBackends[SLIDER_BACKEND_NB] = {
+    { "Magic",       magicBishopAttacks,       magicRookAttacks,       sizeof(BishopAttacks)   + sizeof(RookAttacks)   },
+    { "PEXT",        pextBishopAttacks,        pextRookAttacks,        sizeof(BishopAttacks)   + sizeof(RookAttacks)   },
+    { "PDEP",        pdepBishopAttacks,        pdepRookAttacks,        sizeof(BishopAttacks16) + sizeof(RookAttacks16) },
+    { "Obstruction", obstructionBishopAttacks, obstructionRookAttacks, sizeof(LineMasks)                               },
+};
+
 static uint64_t sliderAttacks(int sq, uint64_t occupied, const int delta[4][2]) {
 
     int rank, file, dr, df;
@@ -74,41 +186,109 @@ static uint64_t sliderAttacks(int sq, uint64_t occupied, const int delta[4][2])
     return result;
 }
 
-static void initSliderAttacks(int sq, Magic *table, uint64_t magic, const int delta[4][2]) {
+static void initSliderAttacks(int sq, Magic *table, uint64_t magic, const int delta[4][2], int backend) {
 
     uint64_t edges = ((RANK_1 | RANK_8) & ~Ranks[rankOf(sq)])
                    | ((FILE_A | FILE_H) & ~Files[fileOf(sq)]);
 
-    uint64_t occupied = 0ull;
+    uint64_t occupied = 0ull, attacks, rays = sliderAttacks(sq, 0, delta);
 
     // Init entry for the given square
     table[sq].magic = magic;
-    table[sq].mask  = sliderAttacks(sq, 0, delta) & ~edges;
+    table[sq].mask  = rays & ~edges;
     table[sq].shift = 64 - popcount(table[sq].mask);
 
     // Track the offset as we use up the table
     if (sq != SQUARE_NB - 1)
         table[sq+1].offset = table[sq].offset + (1 << popcount(table[sq].mask));
 
+    // SLIDER_OBSTRUCTION needs only the masks, from initAttacks()
+    if (backend == SLIDER_OBSTRUCTION)
+        return;
+
     do { // Init attacks for all occupancy variations
-        int index = sliderIndex(occupied, &table[sq]);
-        table[sq].offset[index] = sliderAttacks(sq, occupied, delta);
+
+        attacks = sliderAttacks(sq, occupied, delta);
+
+        if (backend == SLIDER_MAGIC)
+            table[sq].offset[magicIndex(occupied, &table[sq])] = attacks;
+
+        else if (backend == SLIDER_PEXT)
+            table[sq].offset[pext64(occupied, table[sq].mask)] = attacks;
+
+        else { // SLIDER_PDEP, compressing the attacks onto the empty board rays
+            uint16_t *attacks16 = table == RookTable ? RookAttacks16 : BishopAttacks16;
+            uint64_t *attacks64 = table == RookTable ? RookAttacks   : BishopAttacks;
+            attacks16[table[sq].offset - attacks64 + pext64(occupied, table[sq].mask)] = pext64(attacks, rays);
+        }
+
         occupied = (occupied - table[sq].mask) & table[sq].mask;
+
     } while (occupied);
 }
 
-void initAttacks() {
+int defaultSliderBackend() {
+
+    // Fixed at compile time, except for when dispatching at runtime
+#if defined(USE_PDEP)
+    return SLIDER_PDEP;
+#elif defined(USE_OBSTRUCTION)
+    return SLIDER_OBSTRUCTION;
+#elif defined(USE_PEXT)
+    return SLIDER_PEXT;
+#elif defined(USE_DISPATCH)
+    return DispatchPEXT ? SLIDER_PEXT : SLIDER_MAGIC;
+#else
+    return SLIDER_MAGIC;
+#endif
+}
+
+int initSliderBackend(int backend) {
 
-    const int PawnDelta[2][2]   = {{ 1,-1}, { 1, 1}};
-    const int KnightDelta[8][2] = {{-2,-1}, {-2, 1}, {-1,-2}, {-1, 2},{ 1,-2}, { 1, 2}, { 2,-1}, { 2, 1}};
-    const int KingDelta[8][2]   = {{-1,-1}, {-1, 0}, {-1, 1}, { 0,-1},{ 0, 1}, { 1,-1}, { 1, 0}, { 1, 1}};
     const int BishopDelta[4][2] = {{-1,-1}, {-1, 1}, { 1,-1}, { 1, 1}};
     const int RookDelta[4][2]   = {{-1, 0}, { 0,-1}, { 0, 1}, { 1, 0}};
 
+    // PEXT and PDEP are only usable on x86-64 CPUs with BMI2
+#if !defined(USE_PEXT)
+    #if defined(__x86_64__)
+        if ((backend == SLIDER_PEXT || backend == SLIDER_PDEP) && !(CPUFeatures & CPU_BMI2))
+            return 0;
+    #else
+        if (backend == SLIDER_PEXT || backend == SLIDER_PDEP)
+            return 0;
+    #endif
+#endif
+
     // First square has initial offset
     BishopTable[0].offset = BishopAttacks;
     RookTable[0].offset = RookAttacks;
 
+    for (int sq = 0; sq < 64; sq++) {
+        BishopRays[sq] = sliderAttacks(sq, 0ull, BishopDelta);
+        RookRays[sq]   = sliderAttacks(sq, 0ull, RookDelta);
+        initSliderAttacks(sq, BishopTable, BishopMagics[sq], BishopDelta, backend);
+        initSliderAttacks(sq,   RookTable,   RookMagics[sq],   RookDelta, backend);
+    }
+
+    return 1;
+}
+
+void initAttacks() {
+
+#if defined(USE_TABLES)
+
+    // Every table was generated ahead of time, but dispatching at
+    // runtime may have picked a different backend for the sliders
+    if (defaultSliderBackend() != TABLES_SLIDER_BACKEND)
+        initSliderBackend(defaultSliderBackend());
+
+#else
+
+    const int PawnDelta[2][2]   = {{ 1,-1}, { 1, 1}};
+    const int KnightDelta[8][2] = {{-2,-1}, {-2, 1}, {-1,-2}, {-1, 2},{ 1,-2}, { 1, 2}, { 2,-1}, { 2, 1}};
+    const int KingDelta[8][2]   = {{-1,-1}, {-1, 0}, {-1, 1}, { 0,-1},{ 0, 1}, { 1,-1}, { 1, 0}, { 1, 1}};
+    const int LineDelta[4][2]   = {{ 1, 0}, { 0, 1}, { 1, 1}, { 1,-1}};
+
     // Init attack tables for Pawns
     for (int sq = 0; sq < 64; sq++) {
         for (int dir = 0; dir < 2; dir++) {
@@ -125,11 +305,55 @@ void initAttacks() {
         }
     }
 
-    // Init attack tables for sliding pieces
+    // Init the files, ranks, diagonals, and anti-diagonals through each square,
+    // split into the squares below and above it, for Obstruction Difference
     for (int sq = 0; sq < 64; sq++) {
-        initSliderAttacks(sq, BishopTable, BishopMagics[sq], BishopDelta);
-        initSliderAttacks(sq,   RookTable,   RookMagics[sq],   RookDelta);
+        for (int line = 0; line < 4; line++) {
+            for (int step = 1; step < 8; step++) {
+                setSquare(&LineMasks[line][sq][1], rankOf(sq) + step * LineDelta[line][0], fileOf(sq) + step * LineDelta[line][1]);
+                setSquare(&LineMasks[line][sq][0], rankOf(sq) - step * LineDelta[line][0], fileOf(sq) - step * LineDelta[line][1]);
+            }
+        }
     }
+
+    // Init attack tables for sliding pieces
+    initSliderBackend(defaultSliderBackend());
+
+#endif
+}
+
+static void printMagics(FILE *fout, const char *name, const char *attacks, Magic *table, uint64_t *base) {
+
+    // Offsets become addresses within the attack tables printed before them
+    fprintf(fout, "Magic %s[SQUARE_NB] = {\n", name);
+
+    for (int sq = 0; sq < SQUARE_NB; sq++)
+        fprintf(fout, "    { 0x%016" PRIX64 "ull, 0x%016" PRIX64 "ull, %2" PRIu64 ", %s + %6d },\n",
+                table[sq].magic, table[sq].mask, table[sq].shift, attacks, (int)(table[sq].offset - base));
+
+    fprintf(fout, "};\n\n");
+}
+
+void printAttackTables(FILE *fout) {
+
+    // Slider tables are laid out for a single backend, so we note which
+    fprintf(fout, "#define TABLES_SLIDER_BACKEND %d // %s\n\n",
+            defaultSliderBackend(), SliderBackends[defaultSliderBackend()].name);
+
+    printTable(fout, "const uint64_t PawnAttacks[COLOUR_NB][SQUARE_NB]", PawnAttacks, 8, COLOUR_NB * SQUARE_NB);
+    printTable(fout, "const uint64_t KnightAttacks[SQUARE_NB]", KnightAttacks, 8, SQUARE_NB);
+    printTable(fout, "const uint64_t KingAttacks[SQUARE_NB]", KingAttacks, 8, SQUARE_NB);
+    printTable(fout, "const uint64_t LineMasks[4][SQUARE_NB][2]", LineMasks, 8, 4 * SQUARE_NB * 2);
+
+    // The slider tables remain writable, as initSliderBackend() may rebuild them
+    printTable(fout, "uint64_t BishopAttacks[0x1480]", BishopAttacks, 8, 0x1480);
+    printTable(fout, "uint64_t RookAttacks[0x19000]", RookAttacks, 8, 0x19000);
+    printTable(fout, "uint16_t BishopAttacks16[0x1480]", BishopAttacks16, 2, 0x1480);
+    printTable(fout, "uint16_t RookAttacks16[0x19000]", RookAttacks16, 2, 0x19000);
+    printTable(fout, "uint64_t BishopRays[SQUARE_NB]", BishopRays, 8, SQUARE_NB);
+    printTable(fout, "uint64_t RookRays[SQUARE_NB]", RookRays, 8, SQUARE_NB);
+    printMagics(fout, "BishopTable", "BishopAttacks", BishopTable, BishopAttacks);
+    printMagics(fout, "RookTable", "RookAttacks", RookTable, RookAttacks);
 }
 
 uint64_t pawnAttacks(int colour, int sq) {
@@ -145,12 +369,24 @@ uint64_t knightAttacks(int sq) {
 
 uint64_t bishopAttacks(int sq, uint64_t occupied) {
     assert(0 <= sq && sq < SQUARE_NB);
+#if defined(USE_PDEP)
+    return pdepBishopAttacks(sq, occupied);
+#elif defined(USE_OBSTRUCTION)
+    return obstructionBishopAttacks(sq, occupied);
+#else
     return BishopTable[sq].offset[sliderIndex(occupied, &BishopTable[sq])];
+#endif
 }
 
 uint64_t rookAttacks(int sq, uint64_t occupied) {
     assert(0 <= sq && sq < SQUARE_NB);
+#if defined(USE_PDEP)
+    return pdepRookAttacks(sq, occupied);
+#elif defined(USE_OBSTRUCTION)
+    return obstructionRookAttacks(sq, occupied);
+#else
     return RookTable[sq].offset[sliderIndex(occupied, &RookTable[sq])];
+#endif
 }
 
 uint64_t queenAttacks(int sq, uint64_t occupied) {
@@ -192,10 +428,13 @@ uint64_t pawnEnpassCaptures(uint64_t pawns, int epsq, int colour) {
 }
 
 int squareIsAttacked(Board *board, int colour, int sq) {
+    uint64_t occupied = board->colours[WHITE] | board->colours[BLACK];
+    return squareIsAttackedOccupied(board, occupied, colour, sq);
+}
 
-    uint64_t enemy    = board->colours[!colour];
-    uint64_t occupied = board->colours[ colour] | enemy;
+int squareIsAttackedOccupied(Board *board, uint64_t occupied, int colour, int sq) {
 
+    uint64_t enemy        = board->colours[!colour];
     uint64_t enemyPawns   = enemy &  board->pieces[PAWN  ];
     uint64_t enemyKnights = enemy &  board->pieces[KNIGHT];
     uint64_t enemyBishops = enemy & (board->pieces[BISHOP] | board->pieces[QUEEN]);
@@ -205,7 +444,8 @@ int squareIsAttacked(Board *board, int colour, int sq) {
     // Check for attacks to this square. While this function has the same
     // result as using attackersToSquare(board, colour, sq) != 0ull, this
     // has a better running time by avoiding some slider move lookups. The
-    // speed gain is easily proven using the provided PERFT suite
+    // speed gain is easily proven using the provided PERFT suite. We allow
+    // for a modified occupancy, so that we may verify the safety of a King
 
     return (pawnAttacks(colour, sq) & enemyPawns)
         || (knightAttacks(sq) & enemyKnights)
@@ -233,6 +473,66 @@ uint64_t attackersToKingSquare(Board *board) {
 
     // Wrapper for allAttackersToSquare() for use in check detection
     int kingsq = getlsb(board->colours[board->turn] & board->pieces[KING]);
+
+#ifdef USE_ATTACK_MAPS
+
+    // With attack maps we only need to ask the enemy pieces which could
+    // possibly reach the King whether their attacks include the King
+    uint64_t attackers = 0ull, candidates = board->colours[!board->turn]
+                       & (queenAttacks(kingsq, 0ull) | knightAttacks(kingsq));
+
+    while (candidates) {
+        int sq = poplsb(&candidates);
+        if (testBit(board->attacks[sq], kingsq)) setBit(&attackers, sq);
+    }
+
+    return attackers;
+
+#else
+
     uint64_t occupied = board->colours[WHITE] | board->colours[BLACK];
     return allAttackersToSquare(board, occupied, kingsq) & board->colours[!board->turn];
+
+#endif
+}
+
+static uint64_t sliderBlockers(Board *board, int colour, int sq) {
+
+    // Find the pieces of either colour which stand alone between the square
+    // and a slider of the given colour. Sliders are found as though the
+    // board was empty, and then we count the pieces standing between
+
+    uint64_t friendly = board->colours[colour];
+    uint64_t occupied = board->colours[WHITE] | board->colours[BLACK];
+    uint64_t bishops  = friendly & (board->pieces[BISHOP] | board->pieces[QUEEN]);
+    uint64_t rooks    = friendly & (board->pieces[ROOK  ] | board->pieces[QUEEN]);
+    uint64_t sliders, between, blockers = 0ull;
+
+    sliders = (bishops ? bishopAttacks(sq, 0ull) & bishops : 0ull)
+            | (rooks   ?   rookAttacks(sq, 0ull) & rooks   : 0ull);
+
+    while (sliders) {
+        between = bitsBetweenMasks(sq, poplsb(&sliders)) & occupied;
+        if (!several(between)) blockers |= between;
+    }
+
+    return blockers;
+}
+
+uint64_t pinnedToKingSquare(Board *board) {
+
+    // Pinned pieces are our own pieces which stand alone between
+    // our King and an enemy slider which is aimed at our King
+
+    int kingsq = getlsb(board->colours[board->turn] & board->pieces[KING]);
+    return sliderBlockers(board, !board->turn, kingsq) & board->colours[board->turn];
+}
+
+uint64_t discoverersToKingSquare(Board *board) {
+
+    // Discoverers are our own pieces which stand alone between the enemy
+    // King and one of our sliders. Moving them off the line gives check
+
+    int kingsq = getlsb(board->colours[!board->turn] & board->pieces[KING]);
+    return sliderBlockers(board, board->turn, kingsq) & board->colours[board->turn];
 }
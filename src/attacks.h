@@ -18,10 +18,20 @@
 
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include "types.h"
 
+enum {
+    SLIDER_MAGIC,        // Fancy magics, with 840 KB of uint64 attack sets
+    SLIDER_PEXT,         // PEXT indexing into the same tables as magics
+    SLIDER_PDEP,         // PEXT indexing into 210 KB of uint16 attack sets, expanded by PDEP
+    SLIDER_OBSTRUCTION,  // Table free Obstruction Difference, with 4 KB of line masks
+    SLIDER_BACKEND_NB
+};
+
 struct Magic {
     uint64_t magic;
     uint64_t mask;
@@ -29,7 +39,19 @@ struct Magic {
     uint64_t *offset;
 };
 
+struct SliderBackend {
+    const char *name;
+    uint64_t (*bishop)(int sq, uint64_t occupied);
+    uint64_t (*rook)(int sq, uint64_t occupied);
+    size_t bytes;
+};
+
+extern const SliderBackend SliderBackends[SLIDER_BACKEND_NB];
+
 void initAttacks();
+int initSliderBackend(int backend);
+int defaultSliderBackend();
+void printAttackTables(FILE *fout);
 
 uint64_t pawnAttacks(int colour, int sq);
 uint64_t knightAttacks(int sq);
@@ -46,9 +68,12 @@ uint64_t pawnAdvance(uint64_t pawns, uint64_t occupied, int colour);
 uint64_t pawnEnpassCaptures(uint64_t pawns, int epsq, int colour);
 
 int squareIsAttacked(Board *board, int colour, int sq);
+int squareIsAttackedOccupied(Board *board, uint64_t occupied, int colour, int sq);
 uint64_t attackersToSquare(Board *board, int colour, int sq);
 uint64_t allAttackersToSquare(Board *board, uint64_t occupied, int sq);
 uint64_t attackersToKingSquare(Board *board);
+uint64_t pinnedToKingSquare(Board *board);
+uint64_t discoverersToKingSquare(Board *board);
 
 static const uint64_t RookMagics[SQUARE_NB] = {
     0xA180022080400230ull, 0x0040100040022000ull, 0x0080088020001002ull, 0x0080080280841000ull,
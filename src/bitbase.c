@@ -0,0 +1,187 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "attacks.h"
+#include "bitbase.h"
+#include "bitboards.h"
+#include "masks.h"
+#include "time.h"
+#include "types.h"
+
+enum { KPK_INVALID, KPK_UNKNOWN, KPK_DRAW, KPK_WIN };
+
+double KPKGenerationTime; // Milliseconds taken by initBitbases()
+
+#if defined(USE_TABLES)
+
+#include "tables/bitbase.h" // Generated ahead of time by ./Ethereal tablegen
+
+#else
+
+static uint32_t KPKBitbase[KPK_INDEX_NB / 32];
+
+#endif
+
+static int kpkIndex(int turn, int strongKing, int weakKing, int pawn) {
+
+    // The Pawn is always on files A through D, and ranks 2 through 7
+    return strongKing | (weakKing << 6) | (turn << 12)
+         | (fileOf(pawn) << 13) | ((6 - rankOf(pawn)) << 15);
+}
+
+#if !defined(USE_TABLES)
+
+static int kpkInitial(int index) {
+
+    // Decode the position, in which the stronger side is always White
+    const int strongKing = (index >>  0) & 63;
+    const int weakKing   = (index >>  6) & 63;
+    const int turn       = (index >> 12) &  1;
+    const int pawn       = square(6 - (index >> 15), (index >> 13) & 3);
+    const int promotion  = pawn + 8;
+
+    // Kings may not touch, nor share a square with each other or the Pawn
+    if (   distanceBetween(strongKing, weakKing) <= 1
+        || strongKing == pawn || weakKing == pawn)
+        return KPK_INVALID;
+
+    // The weak King may not be in check with White to move
+    if (turn == WHITE && testBit(pawnAttacks(WHITE, pawn), weakKing))
+        return KPK_INVALID;
+
+    // A Pawn on the seventh which promotes without being captured wins
+    if (   turn == WHITE && rankOf(pawn) == 6
+        && strongKing != promotion && weakKing != promotion
+        && (   distanceBetween(weakKing, promotion) > 1
+            || distanceBetween(strongKing, promotion) == 1))
+        return KPK_WIN;
+
+    // Black is stalemated, or may capture an undefended Pawn
+    if (turn == BLACK) {
+
+        uint64_t escapes = kingAttacks(weakKing)
+                         & ~(kingAttacks(strongKing) | pawnAttacks(WHITE, pawn));
+
+        if (!escapes || (escapes & (1ull << pawn)))
+            return KPK_DRAW;
+    }
+
+    return KPK_UNKNOWN;
+}
+
+static int kpkClassify(uint8_t *results, int index) {
+
+    const int strongKing = (index >>  0) & 63;
+    const int weakKing   = (index >>  6) & 63;
+    const int turn       = (index >> 12) &  1;
+    const int pawn       = square(6 - (index >> 15), (index >> 13) & 3);
+
+    // White wins if any move wins, and Black draws if any move draws
+    const int good = turn == WHITE ? KPK_WIN  : KPK_DRAW;
+    const int bad  = turn == WHITE ? KPK_DRAW : KPK_WIN;
+
+    int outcomes = 0;
+    uint64_t moves = kingAttacks(turn == WHITE ? strongKing : weakKing);
+
+    // Moves which lead to illegal positions resolve to KPK_INVALID, and
+    // are then ignored. This covers moving into check, and self-blocking
+    while (moves) {
+        int to = poplsb(&moves);
+        outcomes |= 1 << (turn == WHITE ? results[kpkIndex(BLACK, to, weakKing, pawn)]
+                                        : results[kpkIndex(WHITE, strongKing, to, pawn)]);
+    }
+
+    // Pawn pushes, where promotions were resolved by kpkInitial()
+    if (turn == WHITE && rankOf(pawn) < 6) {
+
+        int push = pawn + 8;
+
+        if (push != strongKing && push != weakKing) {
+
+            outcomes |= 1 << results[kpkIndex(BLACK, strongKing, weakKing, push)];
+
+            if (   rankOf(pawn) == 1 && push + 8 != strongKing && push + 8 != weakKing)
+                outcomes |= 1 << results[kpkIndex(BLACK, strongKing, weakKing, push + 8)];
+        }
+    }
+
+    return (outcomes & (1 << good)) ? good
+         : (outcomes & (1 << KPK_UNKNOWN)) ? KPK_UNKNOWN : bad;
+}
+
+#endif
+
+void initBitbases() {
+
+#if !defined(USE_TABLES) // Otherwise the bitbase was generated ahead of time
+
+    double start = getRealTime();
+    uint8_t *results = malloc(KPK_INDEX_NB);
+    int changed = 1;
+
+    // Classify the positions which are immediately decided
+    for (int index = 0; index < KPK_INDEX_NB; index++)
+        results[index] = kpkInitial(index);
+
+    // Propagate results backwards until nothing changes. Any position
+    // still unknown then has no forced win, and is thus a draw
+    while (changed) {
+        changed = 0;
+        for (int index = 0; index < KPK_INDEX_NB; index++)
+            if (   results[index] == KPK_UNKNOWN
+                && (results[index] = kpkClassify(results, index)) != KPK_UNKNOWN)
+                changed = 1;
+    }
+
+    // Pack the wins into a bitbase of 24 KB
+    for (int index = 0; index < KPK_INDEX_NB; index++)
+        if (results[index] == KPK_WIN)
+            KPKBitbase[index / 32] |= 1u << (index % 32);
+
+    free(results);
+    KPKGenerationTime = getRealTime() - start;
+
+#endif
+}
+
+void printBitbaseTables(FILE *fout) {
+
+    // The packed wins, which remain private to bitbase.c
+    printTable(fout, "static const uint32_t KPKBitbase[KPK_INDEX_NB / 32]", KPKBitbase, 4, KPK_INDEX_NB / 32);
+}
+
+int bitbaseProbeKPK(int strongSide, int strongKing, int pawn, int weakKing, int turn) {
+
+    // Flip the board so that the stronger side is White
+    if (strongSide == BLACK) {
+        strongKing ^= 56, weakKing ^= 56, pawn ^= 56;
+        turn = !turn;
+    }
+
+    // Mirror the board so that the Pawn is on files A through D
+    if (fileOf(pawn) >= 4)
+        strongKing ^= 7, weakKing ^= 7, pawn ^= 7;
+
+    const int index = kpkIndex(turn, strongKing, weakKing, pawn);
+    return (KPKBitbase[index / 32] >> (index % 32)) & 1;
+}
@@ -17,11 +17,13 @@
 */
 
 #include <assert.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 
 #include "bitboards.h"
+#include "cpu.h"
 #include "types.h"
 
 const uint64_t Files[FILE_NB] = {FILE_A, FILE_B, FILE_C, FILE_D, FILE_E, FILE_F, FILE_G, FILE_H};
@@ -77,7 +79,11 @@ int backmost(int colour, uint64_t bb) {
 }
 
 int popcount(uint64_t bb) {
+#if defined(USE_DISPATCH)
+    return DispatchPopcount ? cpuPopcount(bb) : __builtin_popcountll(bb);
+#else
     return __builtin_popcountll(bb);
+#endif
 }
 
 int getlsb(uint64_t bb) {
@@ -139,3 +145,26 @@ void printBitboard(uint64_t bb) {
 
     printf("\n");
 }
+
+void printTable(FILE *fout, const char *decl, const void *table, int width, size_t count) {
+
+    // Emit a C definition of a table of 16, 32, or 64 bit entries, used to
+    // generate the tables ahead of time. Trailing zeros are left implicit
+    while (count > 1 && !(width == 8 ? ((const uint64_t *) table)[count-1]
+                        : width == 4 ? ((const uint32_t *) table)[count-1]
+                        :              ((const uint16_t *) table)[count-1]))
+        count--;
+
+    fprintf(fout, "%s = {", decl);
+
+    for (size_t i = 0; i < count; i++) {
+
+        if (width == 8)
+            fprintf(fout, "%s0x%016" PRIX64 "ull,", i % 4 ? " " : "\n    ", ((const uint64_t *) table)[i]);
+        else
+            fprintf(fout, "%s%" PRIu32 ",", i % 16 ? " " : "\n    ",
+                    width == 4 ? ((const uint32_t *) table)[i] : ((const uint16_t *) table)[i]);
+    }
+
+    fprintf(fout, "\n};\n\n");
+}
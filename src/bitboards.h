@@ -19,7 +19,9 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include "types.h"
 
@@ -82,3 +84,4 @@ void clearBit(uint64_t *bb, int i);
 bool testBit(uint64_t bb, int i);
 
 void printBitboard(uint64_t bb);
+void printTable(FILE *fout, const char *decl, const void *table, int width, size_t count);
@@ -44,10 +44,15 @@ static void clearBoard(Board *board) {
 
     // Wipe the entire board structure, and also set all of
     // the pieces on the board to be EMPTY. Ideally, before
-    // this board is used again we will call boardFromFEN()
+    // this board is used again we will call boardFromFEN().
+    // The key stack is owned by the caller, so we keep it
+
+    uint64_t *history = board->history;
 
     memset(board, 0, sizeof(Board));
     memset(&board->squares, EMPTY, sizeof(board->squares));
+
+    board->history = history;
 }
 
 static void setSquare(Board *board, int colour, int piece, int sq) {
@@ -66,10 +71,31 @@ static void setSquare(Board *board, int colour, int piece, int sq) {
 
     board->psqtmat += PSQT[board->squares[sq]][sq];
     board->hash ^= ZobristKeys[board->squares[sq]][sq];
+    board->materialKey += MaterialKeys[board->squares[sq]][sq];
     if (piece == PAWN || piece == KING)
         board->pkhash ^= ZobristKeys[board->squares[sq]][sq];
 }
 
+#ifdef USE_ATTACK_MAPS
+
+static uint64_t attacksFromSquare(Board *board, int sq, uint64_t occupied) {
+
+    // Attacks made by whatever occupies the square, given some occupancy
+    const int piece = board->squares[sq];
+
+    switch (pieceType(piece)) {
+        case PAWN   : return pawnAttacks(pieceColour(piece), sq);
+        case KNIGHT : return knightAttacks(sq);
+        case BISHOP : return bishopAttacks(sq, occupied);
+        case ROOK   : return rookAttacks(sq, occupied);
+        case QUEEN  : return queenAttacks(sq, occupied);
+        case KING   : return kingAttacks(sq);
+        default     : return 0ull;
+    }
+}
+
+#endif
+
 static int stringToSquare(char *str) {
 
     // Helper for reading the enpass square from a FEN. If no square
@@ -168,8 +194,14 @@ void boardFromFEN(Board *board, const char *fen, int chess960) {
     // Move count: ignore and use zero, as we count since root
     board->numMoves = 0;
 
-    // Need king attackers for move generation
+#ifdef USE_ATTACK_MAPS
+    // Attack maps are kept up to date by applyMove() and revertMove()
+    boardInitAttackMaps(board);
+#endif
+
+    // Need king attackers for move generation. Pinned pieces are found later
     board->kingAttackers = attackersToKingSquare(board);
+    board->pinned = UNKNOWN_BITBOARD;
 
     // We save the game mode in order to comply with the UCI rules for printing
     // moves. If chess960 is not enabled, but we have detected an unconventional
@@ -282,6 +314,84 @@ int boardHasNonPawnMaterial(Board *board, int turn) {
     return (friendly & (kings | pawns)) != friendly;
 }
 
+uint64_t boardPinnedPieces(Board *board) {
+
+    // Pinned pieces are computed on demand, and then kept until the move is
+    // reverted. No position may have every square pinned, so we use ~0ull
+    if (board->pinned == UNKNOWN_BITBOARD)
+        board->pinned = pinnedToKingSquare(board);
+
+    return board->pinned;
+}
+
+void boardCheckInfo(Board *board, CheckInfo *ci) {
+
+    // The squares from which each of our pieces would check the enemy King,
+    // and our pieces which would discover a check when moved off of their
+    // line. Nothing in the search asks for these, so they are not kept
+    const int kingsq        = getlsb(board->colours[!board->turn] & board->pieces[KING]);
+    const uint64_t occupied = board->colours[WHITE] | board->colours[BLACK];
+
+    ci->squares[PAWN  ] = pawnAttacks(!board->turn, kingsq);
+    ci->squares[KNIGHT] = knightAttacks(kingsq);
+    ci->squares[BISHOP] = bishopAttacks(kingsq, occupied);
+    ci->squares[ROOK  ] = rookAttacks(kingsq, occupied);
+    ci->squares[QUEEN ] = ci->squares[BISHOP] | ci->squares[ROOK];
+    ci->discoverers     = discoverersToKingSquare(board);
+}
+
+#ifdef USE_ATTACK_MAPS
+
+void boardInitAttackMaps(Board *board) {
+
+    // Compute the attacks from every square, with empty squares attacking nothing
+    uint64_t occupied = board->colours[WHITE] | board->colours[BLACK];
+
+    for (int sq = 0; sq < SQUARE_NB; sq++)
+        board->attacks[sq] = attacksFromSquare(board, sq, occupied);
+}
+
+void boardUpdateAttackMaps(Board *board, uint64_t changed) {
+
+    // Update the attack maps after the squares in changed have been given new
+    // contents. The update is symmetric, so revertMove() passes the same set
+    // of squares as applyMove() did in order to restore the previous maps
+
+    int sq;
+    uint64_t occupied = board->colours[WHITE] | board->colours[BLACK];
+    uint64_t sliders  = occupied & ~changed & ~board->pieces[PAWN]
+                      & ~board->pieces[KNIGHT] & ~board->pieces[KING];
+
+    // A slider is only affected when one of its rays ran into a changed square.
+    // Any square which was emptied held a blocker that the slider attacked, and
+    // any square which was filled was attacked through, so the old map suffices
+    while (sliders) {
+        sq = poplsb(&sliders);
+        if (board->attacks[sq] & changed)
+            board->attacks[sq] = attacksFromSquare(board, sq, occupied);
+    }
+
+    // The changed squares themselves have a new piece, or are now empty
+    while (changed) {
+        sq = poplsb(&changed);
+        board->attacks[sq] = attacksFromSquare(board, sq, occupied);
+    }
+}
+
+int boardAttackMapsAreValid(Board *board) {
+
+    // Sanity check that the incremental maps match a fresh computation
+    uint64_t occupied = board->colours[WHITE] | board->colours[BLACK];
+
+    for (int sq = 0; sq < SQUARE_NB; sq++)
+        if (board->attacks[sq] != attacksFromSquare(board, sq, occupied))
+            return 0;
+
+    return 1;
+}
+
+#endif
+
 int boardIsDrawn(Board *board, int height) {
 
     // Drawn if any of the three possible cases
@@ -302,8 +412,9 @@ int boardDrawnByRepetition(Board *board, int height) {
 
     int reps = 0;
 
-    // Look through hash histories for our moves
-    for (int i = board->numMoves - 2; i >= 0; i -= 2) {
+    // Look through hash histories for our moves. Each side must undo
+    // a move to repeat, so we may skip the position from two plies ago
+    for (int i = board->numMoves - 4; i >= 0; i -= 2) {
 
         // No draw can occur before a zeroing move
         if (i < board->numMoves - board->halfMoveCounter)
@@ -319,35 +430,47 @@ int boardDrawnByRepetition(Board *board, int height) {
     return 0;
 }
 
-int boardDrawnByInsufficientMaterial(Board *board) {
+int boardHasUpcomingRepetition(Board *board, int height) {
 
-    // Check for KvK, KvN, KvB, and KvNN.
+    const uint64_t occupied = board->colours[WHITE] | board->colours[BLACK];
 
-    return !(board->pieces[PAWN] | board->pieces[ROOK] | board->pieces[QUEEN])
-        && (!several(board->colours[WHITE]) || !several(board->colours[BLACK]))
-        && (    !several(board->pieces[KNIGHT] | board->pieces[BISHOP])
-            || (!board->pieces[BISHOP] && popcount(board->pieces[KNIGHT]) <= 2));
-}
+    // We only claim repetitions for positions found after the root, and
+    // no position from before the last zeroing move may ever be repeated
+    const int end = MIN(height - 1, MIN(board->halfMoveCounter, board->numMoves));
+
+    // Look through hash histories for positions which differ from the current
+    // one by a single reversible move. The Cuckoo tables answer this in O(1)
+    for (int i = 3; i <= end; i += 2) {
 
-uint64_t perft(Board *board, int depth) {
+        uint64_t moveKey = board->hash ^ board->history[board->numMoves - i];
+        int slot = cuckooIndex1(moveKey);
 
-    Undo undo[1];
-    int size = 0;
-    uint64_t found = 0ull;
-    uint16_t moves[MAX_MOVES];
+        if (CuckooKeys[slot] != moveKey)
+            slot = cuckooIndex2(moveKey);
 
-    if (depth == 0) return 1ull;
+        if (CuckooKeys[slot] != moveKey)
+            continue;
 
-    // Call genAllNoisyMoves() & genAllNoisyMoves()
-    size += genAllNoisyMoves(board, moves);
-    size += genAllQuietMoves(board, moves + size);
+        // The move must not be blocked by any pieces in the current position
+        const int from = MoveFrom(CuckooMoves[slot]), to = MoveTo(CuckooMoves[slot]);
+        if (bitsBetweenMasks(from, to) & occupied)
+            continue;
 
-    // Recurse on all valid moves
-    for(size -= 1; size >= 0; size--) {
-        applyMove(board, moves[size], undo);
-        if (moveWasLegal(board)) found += perft(board, depth-1);
-        revertMove(board, moves[size], undo);
+        // The move must also be ours to make, from whichever square is occupied
+        const int piece = board->squares[from] != EMPTY ? board->squares[from] : board->squares[to];
+        if (pieceColour(piece) == board->turn)
+            return 1;
     }
 
-    return found;
+    return 0;
+}
+
+int boardDrawnByInsufficientMaterial(Board *board) {
+
+    // Check for KvK, KvN, KvB, and KvNN.
+
+    return !(board->pieces[PAWN] | board->pieces[ROOK] | board->pieces[QUEEN])
+        && (!several(board->colours[WHITE]) || !several(board->colours[BLACK]))
+        && (    !several(board->pieces[KNIGHT] | board->pieces[BISHOP])
+            || (!board->pieces[BISHOP] && popcount(board->pieces[KNIGHT]) <= 2));
 }
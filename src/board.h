@@ -22,18 +22,30 @@
 
 extern const char *PieceLabel[COLOUR_NB];
 
+static const uint64_t UNKNOWN_BITBOARD = ~0ull;
+
+enum { KEY_STACK_SIZE = 512 };
+
+struct CheckInfo {
+    uint64_t squares[KING], discoverers;
+};
+
 struct Board {
     uint8_t squares[SQUARE_NB];
     uint64_t pieces[8], colours[3];
-    uint64_t hash, pkhash, kingAttackers;
-    uint64_t castleRooks, castleMasks[SQUARE_NB];
+    uint64_t hash, pkhash, materialKey, kingAttackers, pinned;
+    uint64_t castleRooks;
     int turn, epSquare, halfMoveCounter, fullMoveCounter;
     int psqtmat, numMoves, chess960;
-    uint64_t history[512];
+    uint64_t *history, castleMasks[SQUARE_NB];
+    NNUEAccumulator *accumulator;
+#ifdef USE_ATTACK_MAPS
+    uint64_t attacks[SQUARE_NB];
+#endif
 };
 
 struct Undo {
-    uint64_t hash, pkhash, kingAttackers, castleRooks;
+    uint64_t hash, pkhash, materialKey, kingAttackers, pinned, castleRooks;
     int epSquare, halfMoveCounter, psqtmat, capturePiece;
 };
 
@@ -42,9 +54,16 @@ void boardFromFEN(Board *board, const char *fen, int chess960);
 void boardToFEN(Board *board, char *fen);
 void printBoard(Board *board);
 int boardHasNonPawnMaterial(Board *board, int turn);
+uint64_t boardPinnedPieces(Board *board);
+void boardCheckInfo(Board *board, CheckInfo *ci);
 int boardIsDrawn(Board *board, int height);
 int boardDrawnByFiftyMoveRule(Board *board);
 int boardDrawnByRepetition(Board *board, int height);
+int boardHasUpcomingRepetition(Board *board, int height);
 int boardDrawnByInsufficientMaterial(Board *board);
 
-uint64_t perft(Board *board, int depth);
+#ifdef USE_ATTACK_MAPS
+void boardInitAttackMaps(Board *board);
+void boardUpdateAttackMaps(Board *board, uint64_t changed);
+int boardAttackMapsAreValid(Board *board);
+#endif
@@ -16,24 +16,41 @@
   along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <inttypes.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
+#include "attacks.h"
+#include "bitbase.h"
+#include "bitboards.h"
 #include "board.h"
 #include "cmdline.h"
+#include "endgame.h"
+#include "evaluate.h"
+#include "fathom/tbprobe.h"
+#include "masks.h"
 #include "move.h"
+#include "movegen.h"
 #include "search.h"
+#include "syzygy.h"
 #include "texel.h"
 #include "thread.h"
 #include "time.h"
 #include "transposition.h"
 #include "uci.h"
+#include "zobrist.h"
+
+extern int ColourParallelEval; // Defined by Evaluate.c
+extern int EvalCacheMB;        // Defined by Thread.c
+extern int TB_STATISTICS;      // Defined by Syzygy.c
 
 void handleCommandLine(int argc, char **argv) {
 
     // Benchmarker is being run from the command line
-    // USAGE: ./Ethereal bench <depth> <threads> <hash>
+    // USAGE: ./Ethereal bench <depth> <threads> <hash> <syzygy path>
     if (argc > 1 && strEquals(argv[1], "bench")) {
         runBenchmark(argc, argv);
         exit(EXIT_SUCCESS);
@@ -46,6 +63,69 @@ void handleCommandLine(int argc, char **argv) {
         exit(EXIT_SUCCESS);
     }
 
+    // Colour parallel evaluation is being checked against the scalar one
+    // USAGE: ./Ethereal evaldiff <epd>
+    if (argc > 2 && strEquals(argv[1], "evaldiff")) {
+        runEvalDiff(argc, argv);
+        exit(EXIT_SUCCESS);
+    }
+
+    // Specialised endgames are being checked against the Syzygy Tables
+    // USAGE: ./Ethereal egcheck <syzygy path> <positions>
+    if (argc > 2 && strEquals(argv[1], "egcheck")) {
+        runEndgameCheck(argc, argv);
+        exit(EXIT_SUCCESS);
+    }
+
+    // Many threads are probing Syzygy Tables which have not been touched yet
+    // USAGE: ./Ethereal tbstress <syzygy path> <threads> <positions>
+    if (argc > 2 && strEquals(argv[1], "tbstress")) {
+        runTablebaseStress(argc, argv);
+        exit(EXIT_SUCCESS);
+    }
+
+    // The KPK bitbase is being reported on, with a search using it
+    // USAGE: ./Ethereal bitbase <fen> <depth>
+    if (argc > 1 && strEquals(argv[1], "bitbase")) {
+        runBitbaseReport(argc, argv);
+        exit(EXIT_SUCCESS);
+    }
+
+    // Upcoming repetition detection is being checked against known positions
+    // USAGE: ./Ethereal upcoming <file>
+    if (argc > 2 && strEquals(argv[1], "upcoming")) {
+        runUpcomingCheck(argc, argv);
+        exit(EXIT_SUCCESS);
+    }
+
+    // Slider attack backends are being checked and timed
+    // USAGE: ./Ethereal sliderbench <pressure MB>
+    if (argc > 1 && strEquals(argv[1], "sliderbench")) {
+        runSliderBenchmark(argc, argv);
+        exit(EXIT_SUCCESS);
+    }
+
+    // Static Exchange Evaluation is being timed, with and without a SEEContext
+    // USAGE: ./Ethereal seebench
+    if (argc > 1 && strEquals(argv[1], "seebench")) {
+        runSEEBenchmark(argc, argv);
+        exit(EXIT_SUCCESS);
+    }
+
+    // Lookup tables are being written out as C, for building with USE_TABLES
+    // USAGE: ./Ethereal tablegen <directory>
+    if (argc > 2 && strEquals(argv[1], "tablegen")) {
+        runTableGeneration(argc, argv);
+        exit(EXIT_SUCCESS);
+    }
+
+    // The time taken by each phase of initialization is being reported
+    // USAGE: ./Ethereal startup
+    if (argc > 1 && strEquals(argv[1], "startup")) {
+        runStartupReport(argc, argv);
+        exit(EXIT_SUCCESS);
+    }
+
     // Tuner is being run from the command line
     #ifdef TUNE
         runTexelTuning();
@@ -63,6 +143,7 @@ void runBenchmark(int argc, char **argv) {
     Board board;
     Thread *threads;
     Limits limits = {0};
+    uint64_t keyStack[KEY_STACK_SIZE];
 
     int scores[256];
     double times[256];
@@ -72,12 +153,19 @@ void runBenchmark(int argc, char **argv) {
 
     double time;
     uint64_t totalNodes = 0ull;
+    uint64_t cacheHits, probes, nanos;
+    uint64_t totalCacheHits = 0ull, totalProbes = 0ull, totalNanos = 0ull;
 
     int depth     = argc > 2 ? atoi(argv[2]) : 13;
     int nthreads  = argc > 3 ? atoi(argv[3]) :  1;
     int megabytes = argc > 4 ? atoi(argv[4]) : 16;
 
-    initTT(megabytes);
+    board.history = keyStack;
+    TB_STATISTICS = 1;
+
+    if (argc > 5) tb_init(argv[5]);
+
+    initTT(megabytes); allocateTT();
     time = getRealTime();
     threads = createThreadPool(nthreads);
 
@@ -97,6 +185,8 @@ void runBenchmark(int argc, char **argv) {
         scores[i] = threads->info->values[depth];
         times[i] = getRealTime() - limits.start;
         nodes[i] = nodesSearchedThreadPool(threads);
+        tbstatsThreadPool(threads, &cacheHits, &probes, &nanos);
+        totalCacheHits += cacheHits, totalProbes += probes, totalNanos += nanos;
 
         clearTT(); // Reset TT between searches
     }
@@ -122,7 +212,13 @@ void runBenchmark(int argc, char **argv) {
     for (int i = 0; strcmp(Benchmarks[i], ""); i++) totalNodes += nodes[i];
     printf("OVERALL: %53d nodes %8d nps\n", (int)totalNodes, (int)(1000.0f * totalNodes / (time + 1)));
 
-    free(threads);
+    // Report the WDL Cache statistics, if any Tablebases were probed
+    if (totalCacheHits + totalProbes)
+        printf("TBCACHE: %14"PRIu64" hits %14"PRIu64" probes %6.1f%% hitrate %8.2f us/probe\n",
+            totalCacheHits, totalProbes, 100.0 * totalCacheHits / (totalCacheHits + totalProbes),
+            totalProbes ? totalNanos / 1e3 / totalProbes : 0.0);
+
+    deleteThreadPool(threads);
 }
 
 void runEvalBook(int argc, char **argv) {
@@ -131,6 +227,7 @@ void runEvalBook(int argc, char **argv) {
     char line[256];
     Limits limits = {0};
     uint16_t best, ponder;
+    uint64_t keyStack[KEY_STACK_SIZE];
     double start = getRealTime();
 
     FILE *book    = fopen(argv[2], "r");
@@ -140,6 +237,7 @@ void runEvalBook(int argc, char **argv) {
 
     Thread *threads = createThreadPool(nthreads);
 
+    board.history = keyStack;
     limits.multiPV = 1;
     limits.limitedByDepth = 1;
     limits.depthLimit = depth;
@@ -154,4 +252,603 @@ void runEvalBook(int argc, char **argv) {
     }
 
     printf("Time %dms\n", (int)(getRealTime() - start));
-}
\ No newline at end of file
+}
+
+void runEvalDiff(int argc, char **argv) {
+
+    int count = 0, capacity = 1024, mismatches = 0, repeats;
+    char line[512], fen[512], *fields[4], *ptr;
+    double times[2] = { 1e9, 1e9 };
+    Thread *thread;
+
+    FILE *epd = fopen(argv[2], "r");
+    Board *boards = malloc(sizeof(Board) * capacity);
+    uint64_t keyStack[KEY_STACK_SIZE];
+
+    (void) argc;
+
+    if (epd == NULL) {
+        printf("Unable to open %s\n", argv[2]);
+        free(boards);
+        return;
+    }
+
+    // Only the first four fields of each line are used, which makes EPDs
+    // and FENs both acceptable. Every Board shares the one key stack
+    while (fgets(line, sizeof(line), epd) != NULL) {
+
+        if (   !(fields[0] = strtok_r(line, " \n", &ptr)) || !(fields[1] = strtok_r(NULL, " \n", &ptr))
+            || !(fields[2] = strtok_r(NULL, " \n", &ptr)) || !(fields[3] = strtok_r(NULL, " \n", &ptr)))
+            continue;
+
+        if (count == capacity)
+            boards = realloc(boards, sizeof(Board) * (capacity *= 2));
+
+        sprintf(fen, "%s %s %s %s 0 1", fields[0], fields[1], fields[2], fields[3]);
+        boards[count].history = keyStack;
+        boardFromFEN(&boards[count++], fen, 0);
+    }
+
+    fclose(epd);
+
+    // Compare the scalar and colour parallel evaluations of every position
+    for (int i = 0; i < count; i++) {
+
+        ColourParallelEval = 0;
+        int scalar = evaluateBoard(NULL, &boards[i]);
+
+        ColourParallelEval = 1;
+        int paired = evaluateBoard(NULL, &boards[i]);
+
+        if (scalar != paired && mismatches++ < 10) {
+            boardToFEN(&boards[i], fen);
+            printf("Mismatch %d vs %d : %s\n", scalar, paired, fen);
+        }
+    }
+
+    // Time both versions using a Thread's Pawn King and Material Tables, as
+    // in a search, but without an Evaluation Cache to skip the work for us
+    EvalCacheMB = 0, thread = createThreadPool(1), EvalCacheMB = 1;
+    repeats = 1 + 250000 / MAX(1, count);
+
+    for (int round = 0; round < 20; round++) {
+        for (int parallel = 0; parallel <= 1; parallel++) {
+
+            volatile int sink = 0;
+            double start = getRealTime();
+
+            ColourParallelEval = parallel;
+            for (int repeat = 0; repeat < repeats; repeat++)
+                for (int i = 0; i < count; i++)
+                    sink += evaluateBoard(thread, &boards[i]);
+
+            times[parallel] = MIN(times[parallel], getRealTime() - start);
+        }
+    }
+
+    printf("Positions %d, Mismatches %d\n", count, mismatches);
+    printf("Scalar   %.1f ns/eval\n", 1e6 * times[0] / ((double) repeats * count));
+    printf("Parallel %.1f ns/eval\n", 1e6 * times[1] / ((double) repeats * count));
+
+    deleteThreadPool(thread);
+    free(boards);
+}
+
+static int randomEndgamePosition(Board *board, const Endgame *endgame) {
+
+    static const char *Labels = "PNBRQKpnbrqk";
+
+    char grid[SQUARE_NB] = {0}, fen[128], *ptr = fen;
+    int colour = endgame->strongSide, sq, king;
+
+    // Scatter the pieces of the endgame onto the board, keeping Pawns
+    // off of the back ranks, with either side to move
+    for (const char *c = endgame->code; *c; c++) {
+
+        if (*c == 'v') { colour = !endgame->strongSide; continue; }
+
+        do sq = rand64() % SQUARE_NB;
+        while (grid[sq] || (*c == 'P' && testBit(PROMOTION_RANKS, sq)));
+
+        grid[sq] = Labels[strchr(Labels, *c) - Labels + 6 * colour];
+    }
+
+    for (int rank = RANK_NB - 1; rank >= 0; rank--) {
+
+        int empty = 0;
+
+        for (int file = 0; file < FILE_NB; file++) {
+            if (!grid[square(rank, file)]) { empty++; continue; }
+            if (empty) *ptr++ = '0' + empty, empty = 0;
+            *ptr++ = grid[square(rank, file)];
+        }
+
+        if (empty) *ptr++ = '0' + empty;
+        *ptr++ = rank ? '/' : ' ';
+    }
+
+    sprintf(ptr, "%c - - 0 1", rand64() % 2 ? 'w' : 'b');
+    boardFromFEN(board, fen, 0);
+
+    // The side which just moved may not be left in check
+    king = getlsb(board->colours[!board->turn] & board->pieces[KING]);
+    return !squareIsAttacked(board, !board->turn, king);
+}
+
+static int quietEndgamePosition(Board *board) {
+
+    uint16_t moves[MAX_MOVES];
+    int count;
+
+    // Specialised evaluations leave tactics to the search, so we
+    // only check positions without a check or a legal capture
+    if (board->kingAttackers) return 0;
+
+    count = genAllNoisyMoves(board, moves);
+    for (int i = 0; i < count; i++)
+        if (moveIsLegal(board, moves[i])) return 0;
+
+    return 1;
+}
+
+void runEndgameCheck(int argc, char **argv) {
+
+    Board board;
+    uint64_t keyStack[KEY_STACK_SIZE];
+    char fen[128];
+    int positions = argc > 3 ? atoi(argv[3]) : 10000, failures = 0;
+
+    board.history = keyStack;
+
+    if (!tb_init(argv[2]) || TB_LARGEST == 0) {
+        printf("No Syzygy Tables found in %s\n", argv[2]);
+        return;
+    }
+
+    // Scaling functions may only claim draws, while evaluation functions may not
+    // claim a win which is not one, nor disagree with the Tables about who is ahead
+    for (int i = 1; i < EndgameCount; i++) {
+
+        const Endgame *endgame = &Endgames[i];
+        int checked = 0, mismatches = 0;
+
+        if ((int) strlen(endgame->code) - 1 > (int) TB_LARGEST) continue;
+
+        for (int attempt = 0; attempt < 64 * positions && checked < positions; attempt++) {
+
+            if (   !randomEndgamePosition(&board, endgame)
+                || findEndgame(board.materialKey) != i
+                || !quietEndgamePosition(&board))
+                continue;
+
+            unsigned wdl = tablebasesProbeWDL(NULL, &board, 0, 1);
+            if (wdl == TB_RESULT_FAILED) continue;
+
+            int drawn = wdl != TB_WIN && wdl != TB_LOSS, mismatch;
+            checked++;
+
+            if (endgame->type == ENDGAME_SCALE)
+                mismatch = !drawn && scaleEndgame(&board, i, endgame->strongSide) == SCALE_DRAW;
+
+            else {
+                int eval = evaluateBoard(NULL, &board);
+                mismatch = drawn ? abs(eval) >= KNOWN_WIN / 2
+                         : wdl == TB_WIN ? eval <= 0 : eval >= 0;
+            }
+
+            if (mismatch && mismatches++ < 3) {
+                boardToFEN(&board, fen);
+                printf("  Mismatch WDL %u : %s\n", wdl, fen);
+            }
+        }
+
+        failures += mismatches;
+        printf("%-8s %-5s %7d positions %7d mismatches\n", endgame->code,
+            endgame->strongSide == WHITE ? "White" : "Black", checked, mismatches);
+    }
+
+    printf("%d mismatches in total\n", failures);
+}
+
+typedef struct TBStressPosition {
+    uint64_t colours[COLOUR_NB];
+    uint64_t pieces[PIECE_NB];
+    int turn;
+} TBStressPosition;
+
+typedef struct TBStressJob {
+    TBStressPosition *positions;
+    int count, nthreads, next;
+    uint64_t found;
+} TBStressJob;
+
+static void *tablebaseStressWorker(void *cargo) {
+
+    TBStressJob *job = (TBStressJob*) cargo;
+
+    uint64_t found = 0ull;
+    int offset = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+
+    // Each thread walks all of the positions, starting at its own offset, so
+    // that the threads run into many different untouched Tables at once
+    for (int i = 0; i < job->count; i++) {
+
+        TBStressPosition *pos = &job->positions[(i + offset * job->count / job->nthreads) % job->count];
+
+        found += tb_probe_wdl(
+            pos->colours[WHITE], pos->colours[BLACK],
+            pos->pieces[KING  ], pos->pieces[QUEEN ],
+            pos->pieces[ROOK  ], pos->pieces[BISHOP],
+            pos->pieces[KNIGHT], pos->pieces[PAWN  ],
+            0, 0, 0, pos->turn == WHITE ? 1 : 0
+        ) != TB_RESULT_FAILED;
+    }
+
+    __atomic_fetch_add(&job->found, found, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static double tablebaseStressPass(TBStressJob *job) {
+
+    pthread_t *pthreads = malloc(sizeof(pthread_t) * job->nthreads);
+    double start = getRealTime();
+
+    job->next = 0, job->found = 0ull;
+
+    for (int i = 0; i < job->nthreads; i++)
+        pthread_create(&pthreads[i], NULL, &tablebaseStressWorker, job);
+
+    for (int i = 0; i < job->nthreads; i++)
+        pthread_join(pthreads[i], NULL);
+
+    free(pthreads);
+    return getRealTime() - start;
+}
+
+void runTablebaseStress(int argc, char **argv) {
+
+    static const char *Pieces = "PNBRQ";
+
+    Board board;
+    Endgame endgame = {0};
+    TBStressJob job = {0};
+    uint64_t keyStack[KEY_STACK_SIZE];
+    char code[16];
+
+    int nthreads  = argc > 3 ? atoi(argv[3]) : 64;
+    int positions = argc > 4 ? atoi(argv[4]) : 100000;
+
+    board.history = keyStack;
+
+    if (!tb_init(argv[2]) || TB_LARGEST == 0) {
+        printf("No Syzygy Tables found in %s\n", argv[2]);
+        return;
+    }
+
+    job.positions = malloc(sizeof(TBStressPosition) * positions);
+    job.count     = positions;
+    job.nthreads  = nthreads;
+
+    // Scatter random material, of up to the largest cardinality, onto the
+    // board, so that the positions are spread over as many Tables as exist
+    for (int i = 0; i < positions; ) {
+
+        int pieces = 3 + rand64() % (TB_LARGEST - 2), length = 0;
+        int split  = 1 + rand64() % (pieces - 1);
+
+        for (int j = 0; j < pieces; j++) {
+            if (j == 0 || j == split) code[length++] = 'K';
+            else code[length++] = Pieces[rand64() % 5];
+            if (j == split - 1) code[length++] = 'v';
+        }
+
+        code[length] = '\0';
+        endgame.code = code, endgame.strongSide = WHITE;
+        if (!randomEndgamePosition(&board, &endgame)) continue;
+
+        memcpy(job.positions[i].colours, board.colours, sizeof(board.colours));
+        memcpy(job.positions[i].pieces, board.pieces, sizeof(board.pieces));
+        job.positions[i++].turn = board.turn;
+    }
+
+    // The first pass maps each Table as the threads reach it, and the second
+    // pass, with every Table mapped, gives the cost of the probes alone
+    double cold = tablebaseStressPass(&job);
+    double warm = tablebaseStressPass(&job);
+
+    printf("tbstress %d threads, %d positions, %"PRIu64" found, cold %.0fms, warm %.0fms, %.2f Mprobes/s\n",
+        nthreads, positions, job.found, cold, warm, (double) nthreads * positions / (warm + 1) / 1e3);
+
+    free(job.positions);
+}
+
+void runBitbaseReport(int argc, char **argv) {
+
+    Board board;
+    Limits limits = {0};
+    uint16_t best, ponder;
+    uint64_t keyStack[KEY_STACK_SIZE];
+
+    char *fen  = argc > 2 ? argv[2] : "8/8/8/8/2k5/8/3P4/3K4 w - - 0 1";
+    int depth  = argc > 3 ? atoi(argv[3]) : 24;
+
+    printf("KPK bitbase: %d positions in %d bytes, generated in %.2fms\n",
+        KPK_INDEX_NB, KPK_INDEX_NB / 8, KPKGenerationTime);
+
+    // Search the position, counting the probes made into the bitbase
+    Thread *threads = createThreadPool(1);
+    board.history = keyStack;
+    boardFromFEN(&board, fen, 0);
+
+    limits.multiPV        = 1;
+    limits.limitedByDepth = 1;
+    limits.depthLimit     = depth;
+    limits.start          = getRealTime();
+
+    getBestMove(threads, &board, &limits, &best, &ponder);
+
+    printf("Searched %"PRIu64" nodes with %"PRIu64" bitbase probes in %dms\n",
+        nodesSearchedThreadPool(threads), threads->kpkProbes, (int)(getRealTime() - limits.start));
+
+    deleteThreadPool(threads);
+}
+
+void runUpcomingCheck(int argc, char **argv) {
+
+    Board board;
+    char line[512], *split;
+    int tested = 0, fails = 0;
+    uint64_t keyStack[KEY_STACK_SIZE];
+
+    FILE *fin = fopen(argv[2], "r");
+
+    (void) argc;
+
+    if (fin == NULL) {
+        printf("Unable to open %s\n", argv[2]);
+        return;
+    }
+
+    // Each line is a UCI position, with the full game considered to
+    // be after the root, and the expected result after the semicolon
+    while (fgets(line, sizeof(line), fin) != NULL) {
+
+        if ((split = strchr(line, ';')) == NULL)
+            continue;
+
+        *split = '\0';
+        for (char *end = split - 1; end >= line && *end == ' '; end--)
+            *end = '\0';
+
+        board.history = keyStack;
+        uciPosition(line, &board, 0);
+
+        int expected = atoi(split + 1);
+        int found = boardHasUpcomingRepetition(&board, board.numMoves + 1);
+
+        if (found != expected && ++fails)
+            printf("Expected %d, found %d : %s\n", expected, found, line);
+
+        tested++;
+    }
+
+    fclose(fin);
+    printf("upcoming %s: %d positions, %d fails\n", argv[2], tested, fails);
+}
+
+static double nanoseconds() {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return 1e9 * ts.tv_sec + ts.tv_nsec;
+}
+
+static double timeSlidersHot(uint64_t (*func)(int, uint64_t), const int *squares, const uint64_t *occupied) {
+
+    uint64_t chain = 0ull;
+    double start = nanoseconds();
+
+    // Each lookup depends on the last, so that we measure latency
+    for (int i = 0; i < 20000000; i++)
+        chain ^= func(squares[i & 4095], occupied[i & 4095] ^ (chain & 1));
+
+    // Keep the compiler from removing the loop
+    if (chain == 0x1234567ull) printf(" ");
+
+    return (nanoseconds() - start) / 20000000;
+}
+
+static double timeSlidersCold(uint64_t (*func)(int, uint64_t), const int *squares,
+                              const uint64_t *occupied, const uint64_t *pressure, uint64_t length) {
+
+    uint64_t chain = 0ull, sink = 0ull;
+    double elapsed = 0.0;
+
+    for (int i = 0; i < 500; i++) {
+
+        // Stream through the pressure buffer, evicting the tables from the L2
+        for (uint64_t j = 0; j < length; j += 8)
+            sink += pressure[j];
+
+        // Time a short dependent chain of lookups, into the evicted tables
+        double start = nanoseconds();
+        for (int j = 0; j < 64; j++)
+            chain ^= func(squares[(i * 64 + j) & 4095], occupied[(i * 64 + j) & 4095] ^ (chain & 1));
+        elapsed += nanoseconds() - start;
+    }
+
+    // Keep the compiler from removing the loops
+    if ((chain ^ sink) == 0x1234567ull) printf(" ");
+
+    return elapsed / (500 * 64);
+}
+
+void runSliderBenchmark(int argc, char **argv) {
+
+    static int squares[4096];
+    static uint64_t occupied[4096], bishops[4096], rooks[4096];
+
+    const int megabytes = argc > 2 ? atoi(argv[2]) : 4;
+    const uint64_t length = (uint64_t) megabytes * 1024 * 1024 / sizeof(uint64_t);
+
+    uint64_t *pressure = calloc(length, sizeof(uint64_t));
+    int errors = 0;
+
+    // Middlegame like occupancies, with about a quarter of the squares filled
+    for (int i = 0; i < 4096; i++) {
+        squares[i] = rand64() % SQUARE_NB;
+        occupied[i] = rand64() & rand64();
+        bishops[i] = bishopAttacks(squares[i], occupied[i]);
+        rooks[i] = rookAttacks(squares[i], occupied[i]);
+    }
+
+    // Fault in the pages of the pressure buffer
+    for (uint64_t i = 0; i < length; i++) pressure[i] = i;
+
+    printf("Backend        Tables   Bishop ns   Rook ns   Bishop ns   Rook ns\n");
+    printf("                        (hot)       (hot)     (%dMB)       (%dMB)\n", megabytes, megabytes);
+
+    for (int backend = 0; backend < SLIDER_BACKEND_NB; backend++) {
+
+        const SliderBackend *slider = &SliderBackends[backend];
+
+        if (!initSliderBackend(backend)) {
+            printf("%-12s   not supported on this CPU\n", slider->name);
+            continue;
+        }
+
+        // Every backend must agree with the one used by the search
+        for (int i = 0; i < 4096; i++)
+            errors += slider->bishop(squares[i], occupied[i]) != bishops[i]
+                   || slider->rook(squares[i], occupied[i])   != rooks[i];
+
+        printf("%-12s %6dKB %10.2f %9.2f %11.2f %9.2f\n", slider->name, (int) (slider->bytes / 1024),
+            timeSlidersHot(slider->bishop, squares, occupied),
+            timeSlidersHot(slider->rook, squares, occupied),
+            timeSlidersCold(slider->bishop, squares, occupied, pressure, length),
+            timeSlidersCold(slider->rook, squares, occupied, pressure, length));
+
+        // Restore the tables used by the search, which may share memory
+        initSliderBackend(defaultSliderBackend());
+    }
+
+    printf("%d mismatches against the search's backend\n", errors);
+    free(pressure);
+}
+
+static void timeSEECalls(Board *board, uint64_t *calls, double *shared, double *fresh) {
+
+    SEEContext see;
+    uint16_t moves[MAX_MOVES];
+    int count = genAllNoisyMoves(board, moves), found = 0;
+    double start;
+
+    if (count == 0) return;
+
+    // SEE calls at one node, sharing the SEEContext as the Move Picker does
+    start = nanoseconds();
+    initSEEContext(&see, board);
+    for (int repeat = 0; repeat < 1000; repeat++)
+        for (int i = 0; i < count; i++)
+            found += staticExchangeEvaluation(board, &see, moves[i], 0);
+    *shared += nanoseconds() - start;
+
+    // The same calls, building the occupancy and slider sets every time
+    start = nanoseconds();
+    for (int repeat = 0; repeat < 1000; repeat++)
+        for (int i = 0; i < count; i++)
+            initSEEContext(&see, board), found += staticExchangeEvaluation(board, &see, moves[i], 0);
+    *fresh += nanoseconds() - start;
+
+    // Keep the compiler from removing the loops
+    if (found == -1) printf(" ");
+
+    *calls += 1000 * count;
+}
+
+void runSEEBenchmark(int argc, char **argv) {
+
+    static const char *Benchmarks[] = {
+        #include "bench.csv"
+        ""
+    };
+
+    Board board;
+    Undo undo[1];
+    uint16_t moves[MAX_MOVES];
+    uint64_t keyStack[KEY_STACK_SIZE];
+    uint64_t calls = 0ull;
+    double shared = 0.0, fresh = 0.0;
+
+    (void) argc, (void) argv;
+
+    board.history = keyStack;
+
+    for (int i = 0; strcmp(Benchmarks[i], ""); i++) {
+
+        // Time SEE on every capture from the position and from each child
+        boardFromFEN(&board, Benchmarks[i], 0);
+        timeSEECalls(&board, &calls, &shared, &fresh);
+
+        int count = genAllLegalMoves(&board, moves);
+        for (int j = 0; j < count; j++) {
+            applyMove(&board, moves[j], undo);
+            timeSEECalls(&board, &calls, &shared, &fresh);
+            revertMove(&board, moves[j], undo);
+        }
+    }
+
+    printf("%"PRIu64" SEE calls, %.2f ns/call with a shared SEEContext, %.2f ns/call without\n",
+        calls, shared / calls, fresh / calls);
+}
+
+void runTableGeneration(int argc, char **argv) {
+
+    static const char *Names[] = { "attacks", "masks", "bitbase" };
+    static void (*const Printers[])(FILE *) = { printAttackTables, printMaskTables, printBitbaseTables };
+
+    char path[512];
+
+    (void) argc;
+
+    // Each module includes its own file of tables, from the given directory
+    for (int i = 0; i < 3; i++) {
+
+        FILE *fout = fopen((sprintf(path, "%.480s/%s.h", argv[2], Names[i]), path), "w");
+
+        if (fout == NULL) {
+            printf("Unable to open %s\n", path);
+            exit(EXIT_FAILURE);
+        }
+
+        // Multidimensional tables are printed as flat lists of entries
+        fprintf(fout, "// Generated by ./Ethereal tablegen, for builds with USE_TABLES\n\n");
+        fprintf(fout, "#pragma GCC diagnostic push\n");
+        fprintf(fout, "#pragma GCC diagnostic ignored \"-Wmissing-braces\"\n\n");
+        Printers[i](fout);
+        fprintf(fout, "#pragma GCC diagnostic pop\n");
+        fclose(fout);
+
+        printf("Wrote %s\n", path);
+    }
+}
+
+void runStartupReport(int argc, char **argv) {
+
+    double total = 0.0;
+
+    (void) argc; (void) argv;
+
+    // Phases were timed by main() before handling the command line
+    for (int i = 0; i < StartupPhaseCount; i++) {
+        printf("%-20s %8.3f ms\n", StartupPhases[i].name, StartupPhases[i].elapsed);
+        total += StartupPhases[i].elapsed;
+    }
+
+    printf("%-20s %8.3f ms\n", "Total", total);
+
+#if defined(USE_TABLES)
+    printf("Tables were generated ahead of time\n");
+#else
+    printf("Tables were computed at startup\n");
+#endif
+}
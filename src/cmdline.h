@@ -21,3 +21,12 @@
 void handleCommandLine(int argc, char **argv);
 void runBenchmark(int argc, char **argv);
 void runEvalBook(int argc, char **argv);
+void runEvalDiff(int argc, char **argv);
+void runEndgameCheck(int argc, char **argv);
+void runTablebaseStress(int argc, char **argv);
+void runBitbaseReport(int argc, char **argv);
+void runUpcomingCheck(int argc, char **argv);
+void runSliderBenchmark(int argc, char **argv);
+void runSEEBenchmark(int argc, char **argv);
+void runTableGeneration(int argc, char **argv);
+void runStartupReport(int argc, char **argv);
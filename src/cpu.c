@@ -0,0 +1,122 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <cpuid.h>
+#endif
+
+#include "cpu.h"
+
+int CPUFeatures;      // Set by initCPU(), from the cpuid instruction
+int DispatchPopcount; // Use the popcnt instruction, when USE_DISPATCH
+int DispatchPEXT;     // Index sliders with PEXT instead of magics, when USE_DISPATCH
+
+static int cpuDetectFeatures() {
+
+    int features = 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+
+    unsigned eax, ebx, ecx, edx, family;
+    char vendor[13] = {0};
+
+    if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx))
+        return 0;
+
+    memcpy(vendor + 0, &ebx, 4);
+    memcpy(vendor + 4, &edx, 4);
+    memcpy(vendor + 8, &ecx, 4);
+
+    // Leaf 1 has POPCNT, the extended family, and OS support for AVX
+    __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+    family = ((eax >> 8) & 0xF) + (((eax >> 8) & 0xF) == 0xF ? (eax >> 20) & 0xFF : 0);
+    int osxsave = (ecx >> 27) & 1;
+
+    if ((ecx >> 23) & 1) features |= CPU_POPCNT;
+
+    // Zen1 and Zen2 (family 17h) implement PEXT in microcode, at a cost
+    // of up to hundreds of cycles, so magics are much faster there
+    if (!strcmp(vendor, "AuthenticAMD") && family == 0x17)
+        features |= CPU_SLOW_PEXT;
+
+    // Leaf 7 has BMI2 and AVX2. AVX2 also needs the OS to save the YMM state
+    if (__get_cpuid_max(0, NULL) >= 7) {
+
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+
+        if ((ebx >> 8) & 1) features |= CPU_BMI2;
+
+        if (((ebx >> 5) & 1) && osxsave) {
+            unsigned xcr0, xcr0hi;
+            __asm__ ("xgetbv" : "=a" (xcr0), "=d" (xcr0hi) : "c" (0));
+            if ((xcr0 & 6) == 6) features |= CPU_AVX2;
+        }
+    }
+
+#endif
+
+    return features;
+}
+
+void initCPU() {
+
+    // Must run before initAttacks(), as the choice of slider indexing
+    // decides the layout of the sliding attack tables
+    CPUFeatures = cpuDetectFeatures();
+
+#if defined(USE_DISPATCH)
+    DispatchPopcount = !!(CPUFeatures & CPU_POPCNT);
+    DispatchPEXT     =  (CPUFeatures & CPU_BMI2) && !(CPUFeatures & CPU_SLOW_PEXT);
+#endif
+}
+
+const char *cpuPathName() {
+
+    // Builds without USE_DISPATCH have their path fixed at compile time
+
+#if defined(USE_DISPATCH)
+    return DispatchPEXT ? "PEXT" : DispatchPopcount ? "POPCNT" : "Magic";
+#elif defined(USE_PDEP)
+    return "PDEP";
+#elif defined(USE_PEXT)
+    return "PEXT";
+#elif defined(USE_OBSTRUCTION)
+    return "Obstruction";
+#elif defined(USE_POPCNT)
+    return "POPCNT";
+#else
+    return NULL;
+#endif
+}
+
+const char *cpuNNUEHint() {
+
+    // Dispatching builds target a baseline x86-64, so the NNUE kernels
+    // are compiled for SSE2 even where the CPU could have run AVX2
+
+#if defined(USE_DISPATCH) && !defined(__AVX2__)
+    if (CPUFeatures & CPU_AVX2)
+        return "NNUE is using SSE2 kernels, build the popcnt or pext target for AVX2";
+#endif
+
+    return NULL;
+}
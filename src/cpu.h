@@ -0,0 +1,62 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stdint.h>
+
+enum {
+    CPU_POPCNT    = 1 << 0,
+    CPU_BMI2      = 1 << 1,
+    CPU_SLOW_PEXT = 1 << 2, // AMD Zen1 and Zen2 microcode PEXT
+    CPU_AVX2      = 1 << 3,
+};
+
+void initCPU();
+const char *cpuPathName();
+const char *cpuNNUEHint();
+
+extern int CPUFeatures;
+extern int DispatchPopcount;
+extern int DispatchPEXT;
+
+#if defined(__x86_64__)
+
+// The assembler accepts these without -mpopcnt or -mbmi2, which lets
+// them be inlined anywhere, and only executed once the CPU is checked
+
+static inline int cpuPopcount(uint64_t bb) {
+    uint64_t count;
+    __asm__ ("popcntq %1, %0" : "=r" (count) : "r" (bb));
+    return (int) count;
+}
+
+static inline uint64_t cpuPext(uint64_t bb, uint64_t mask) {
+    uint64_t result;
+    __asm__ ("pextq %2, %1, %0" : "=r" (result) : "r" (bb), "r" (mask));
+    return result;
+}
+
+static inline uint64_t cpuPdep(uint64_t bb, uint64_t mask) {
+    uint64_t result;
+    __asm__ ("pdepq %2, %1, %0" : "=r" (result) : "r" (bb), "r" (mask));
+    return result;
+}
+
+#endif
@@ -0,0 +1,283 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bitbase.h"
+#include "bitboards.h"
+#include "board.h"
+#include "endgame.h"
+#include "evaluate.h"
+#include "masks.h"
+#include "types.h"
+#include "zobrist.h"
+
+Endgame Endgames[MAX_ENDGAMES];
+int EndgameCount = 1; // Index zero is reserved for "no endgame"
+
+static int PushToEdge[SQUARE_NB];
+static int PushClose[8];
+static int PushAway[8];
+
+static const uint64_t Corners = 0x8100000000000081ull;
+
+static int manhattanDistance(int sq1, int sq2) {
+    return abs(fileOf(sq1) - fileOf(sq2)) + abs(rankOf(sq1) - rankOf(sq2));
+}
+
+static int kingSquareOf(Board *board, int colour) {
+    return getlsb(board->colours[colour] & board->pieces[KING]);
+}
+
+static int evaluateKXK(Board *board, int strongSide) {
+
+    // Lone King against enough material to mate, where we only need to
+    // drive the King to the edge, and bring our own King in for support
+
+    const uint64_t strong  = board->colours[strongSide];
+    const uint64_t bishops = strong & board->pieces[BISHOP];
+
+    const int strongKing = kingSquareOf(board, strongSide);
+    const int weakKing   = kingSquareOf(board, !strongSide);
+
+    // Two Bishops on the same colour of square can never deliver mate
+    if (!(strong & (board->pieces[QUEEN] | board->pieces[ROOK]))
+        && (!(bishops & WHITE_SQUARES) || !(bishops & BLACK_SQUARES)))
+        return 0;
+
+    return KNOWN_WIN
+         + popcount(strong & board->pieces[QUEEN ]) * ScoreEG(QueenValue)
+         + popcount(strong & board->pieces[ROOK  ]) * ScoreEG(RookValue)
+         + popcount(strong & board->pieces[BISHOP]) * ScoreEG(BishopValue)
+         + PushToEdge[weakKing] + PushClose[distanceBetween(strongKing, weakKing)];
+}
+
+static int evaluateKBNK(Board *board, int strongSide) {
+
+    // Mate with Bishop and Knight is only possible in the two corners
+    // matching the colour of the Bishop, so we drive the King to them
+
+    const int strongKing = kingSquareOf(board, strongSide);
+    const int weakKing   = kingSquareOf(board, !strongSide);
+    const int bishop     = getlsb(board->colours[strongSide] & board->pieces[BISHOP]);
+
+    const uint64_t corners = Corners & squaresOfMatchingColour(bishop);
+    const int cornerDistance = MIN(manhattanDistance(weakKing, getlsb(corners)),
+                                   manhattanDistance(weakKing, getmsb(corners)));
+
+    return KNOWN_WIN + ScoreEG(BishopValue) + ScoreEG(KnightValue)
+         + PushToEdge[weakKing] + 24 * (14 - cornerDistance)
+         + PushClose[distanceBetween(strongKing, weakKing)];
+}
+
+static int evaluateKQKR(Board *board, int strongSide) {
+
+    // Generally won, but only slowly, by driving the King to the edge
+
+    const int strongKing = kingSquareOf(board, strongSide);
+    const int weakKing   = kingSquareOf(board, !strongSide);
+
+    return ScoreEG(QueenValue) - ScoreEG(RookValue)
+         + PushToEdge[weakKing] + PushClose[distanceBetween(strongKing, weakKing)];
+}
+
+static int evaluateKPK(Board *board, int strongSide) {
+
+    // Exact results come from the KPK bitbase. Won positions are scored
+    // by the advancement of the Pawn, so the search can make progress
+
+    const int strongKing = kingSquareOf(board, strongSide);
+    const int weakKing   = kingSquareOf(board, !strongSide);
+    const int pawn       = getlsb(board->pieces[PAWN]);
+
+    if (!bitbaseProbeKPK(strongSide, strongKing, pawn, weakKing, board->turn))
+        return 0;
+
+    return KNOWN_WIN + ScoreEG(PawnValue) + 16 * relativeRankOf(strongSide, pawn);
+}
+
+static int evaluateKRKP(Board *board, int strongSide) {
+
+    // Usually won when our King can reach the Pawn in time, and drawn when
+    // the Pawn is far advanced with its King in support while ours is far
+
+    const int weakSide   = !strongSide;
+    const int strongKing = kingSquareOf(board, strongSide);
+    const int weakKing   = kingSquareOf(board, weakSide);
+    const int rook       = getlsb(board->pieces[ROOK]);
+    const int pawn       = getlsb(board->pieces[PAWN]);
+    const int rank       = relativeRankOf(weakSide, pawn);
+    const int advance    = pawn + (weakSide == WHITE ? 8 : -8);
+    const int promotion  = square(weakSide == WHITE ? 7 : 0, fileOf(pawn));
+
+    // Our King is in front of the Pawn
+    if (   fileOf(strongKing) == fileOf(pawn)
+        && relativeRankOf(weakSide, strongKing) > rank)
+        return ScoreEG(RookValue) - distanceBetween(strongKing, pawn);
+
+    // The defending King is too far from both the Pawn and the Rook
+    if (   distanceBetween(weakKing, pawn) >= 3 + (board->turn == weakSide)
+        && distanceBetween(weakKing, rook) >= 3)
+        return ScoreEG(RookValue) - distanceBetween(strongKing, pawn);
+
+    // The Pawn is far advanced and supported, while our King is far away
+    if (   relativeRankOf(weakSide, weakKing) >= 5
+        && distanceBetween(weakKing, pawn) == 1
+        && relativeRankOf(strongSide, strongKing) >= 3
+        && distanceBetween(strongKing, pawn) > 2 + (board->turn == strongSide))
+        return 80 - 8 * distanceBetween(strongKing, pawn);
+
+    return 200 - 8 * (  distanceBetween(strongKing, advance)
+                      - distanceBetween(weakKing, advance)
+                      - distanceBetween(pawn, promotion));
+}
+
+static int evaluateKRKB(Board *board, int strongSide) {
+
+    // Drawish, but the defender can still be pressed against the edge
+    return PushToEdge[kingSquareOf(board, !strongSide)];
+}
+
+static int evaluateKRKN(Board *board, int strongSide) {
+
+    // Drawish, but more so while the Knight stays close to its King
+    const int weakKing = kingSquareOf(board, !strongSide);
+    const int knight   = getlsb(board->pieces[KNIGHT]);
+    return PushToEdge[weakKing] + PushAway[distanceBetween(weakKing, knight)];
+}
+
+static int scaleKBPsK(Board *board, int strongSide) {
+
+    // Rook Pawns with a Bishop which does not control the promotion square
+    // are drawn once the defending King reaches the corner in front of them
+
+    const uint64_t pawns = board->pieces[PAWN];
+    const int weakKing   = kingSquareOf(board, !strongSide);
+    const int bishop     = getlsb(board->pieces[BISHOP]);
+
+    if ((pawns & ~Files[0]) && (pawns & ~Files[7]))
+        return SCALE_NONE;
+
+    const int promotion = square(strongSide == WHITE ? 7 : 0, fileOf(getlsb(pawns)));
+
+    if (   !(squaresOfMatchingColour(bishop) & (1ull << promotion))
+        && distanceBetween(weakKing, promotion) <= 1)
+        return SCALE_DRAW;
+
+    return SCALE_NONE;
+}
+
+static void registerEndgame(const char *code, EndgameFunc func, int type) {
+
+    static const char *Labels = "PNBRQK";
+
+    int bishops = 0;
+
+    // The Material Key splits Bishops by the colour of their square, so we
+    // register the endgame once for each possible pairing of square colours
+    for (const char *c = code; *c; c++)
+        bishops += *c == 'B';
+
+    for (int strongSide = WHITE; strongSide <= BLACK; strongSide++) {
+        for (int variant = 0; variant < (1 << bishops); variant++) {
+
+            uint64_t key = 0ull;
+            int colour = strongSide, bishop = 0;
+
+            // A1 and B1 differ in colour, and serve as the two Bishop squares
+            for (const char *c = code; *c; c++) {
+
+                if (*c == 'v') { colour = !strongSide; continue; }
+
+                int piece = strchr(Labels, *c) - Labels;
+                int sq = piece == BISHOP ? (variant >> bishop++) & 1 : 0;
+                key += MaterialKeys[makePiece(piece, colour)][sq];
+            }
+
+            // Reordering the colours of two Bishops gives the same key
+            if (findEndgame(key) || EndgameCount == MAX_ENDGAMES)
+                continue;
+
+            Endgames[EndgameCount++] = (Endgame) { key, func, code, type, strongSide };
+        }
+    }
+}
+
+void initEndgames() {
+
+    // Bonuses for a weak King pushed towards the edge of the board, for
+    // Kings standing close together, and for pieces kept far from the King
+    for (int sq = 0; sq < SQUARE_NB; sq++) {
+        int file = MAX(3 - fileOf(sq), fileOf(sq) - 4);
+        int rank = MAX(3 - rankOf(sq), rankOf(sq) - 4);
+        PushToEdge[sq] = 20 * MAX(file, rank) + 6 * (file + rank);
+    }
+
+    for (int distance = 0; distance < 8; distance++) {
+        PushClose[distance] = 140 - 20 * distance;
+        PushAway[distance]  = 16 * distance;
+    }
+
+    // Endgames are written from the view of the stronger side, before the 'v'
+    registerEndgame("KQvK",   evaluateKXK,  ENDGAME_EVAL );
+    registerEndgame("KRvK",   evaluateKXK,  ENDGAME_EVAL );
+    registerEndgame("KQQvK",  evaluateKXK,  ENDGAME_EVAL );
+    registerEndgame("KQRvK",  evaluateKXK,  ENDGAME_EVAL );
+    registerEndgame("KRRvK",  evaluateKXK,  ENDGAME_EVAL );
+    registerEndgame("KBBvK",  evaluateKXK,  ENDGAME_EVAL );
+    registerEndgame("KBNvK",  evaluateKBNK, ENDGAME_EVAL );
+    registerEndgame("KQvKR",  evaluateKQKR, ENDGAME_EVAL );
+    registerEndgame("KPvK",   evaluateKPK,  ENDGAME_EVAL );
+    registerEndgame("KRvKP",  evaluateKRKP, ENDGAME_EVAL );
+    registerEndgame("KRvKB",  evaluateKRKB, ENDGAME_EVAL );
+    registerEndgame("KRvKN",  evaluateKRKN, ENDGAME_EVAL );
+    registerEndgame("KBPvK",  scaleKBPsK,   ENDGAME_SCALE);
+    registerEndgame("KBPPvK", scaleKBPsK,   ENDGAME_SCALE);
+}
+
+int findEndgame(uint64_t key) {
+
+    // Only called when a Material Entry is computed, so a scan is cheap
+    for (int i = 1; i < EndgameCount; i++)
+        if (Endgames[i].key == key) return i;
+
+    return 0;
+}
+
+int evaluateEndgame(Board *board, int index) {
+
+    // Specialised evaluations are from the view of the stronger side
+    const Endgame *endgame = &Endgames[index];
+    int eval = endgame->func(board, endgame->strongSide);
+    return board->turn == endgame->strongSide ? eval : -eval;
+}
+
+int endgameProbesKPK(int index) {
+
+    // Lets each Thread count its own probes into the KPK bitbase
+    return Endgames[index].func == evaluateKPK;
+}
+
+int scaleEndgame(Board *board, int index, int strongSide) {
+
+    // Scaling functions only apply when their side is the one ahead
+    const Endgame *endgame = &Endgames[index];
+    return endgame->strongSide == strongSide ? endgame->func(board, strongSide) : SCALE_NONE;
+}
@@ -0,0 +1,49 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "types.h"
+
+enum {
+    KNOWN_WIN = 10000,   // Base score for trivially won endings
+    MAX_ENDGAMES = 64,   // Capacity of the registry, including both colours
+    SCALE_NONE = -1,     // Returned by scaling functions with no opinion
+};
+
+enum { ENDGAME_EVAL, ENDGAME_SCALE };
+
+typedef int (*EndgameFunc)(Board *board, int strongSide);
+
+struct Endgame {
+    uint64_t key;
+    EndgameFunc func;
+    const char *code;
+    int type, strongSide;
+};
+
+void initEndgames();
+int findEndgame(uint64_t key);
+int evaluateEndgame(Board *board, int index);
+int scaleEndgame(Board *board, int index, int strongSide);
+int endgameProbesKPK(int index);
+
+extern Endgame Endgames[MAX_ENDGAMES];
+extern int EndgameCount;
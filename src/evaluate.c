@@ -22,8 +22,11 @@
 #include "attacks.h"
 #include "bitboards.h"
 #include "board.h"
+#include "endgame.h"
 #include "evaluate.h"
 #include "masks.h"
+#include "nnue.h"
+#include "thread.h"
 #include "transposition.h"
 #include "types.h"
 
@@ -354,13 +357,61 @@ const int ComplexityAdjustment  = S(   0,-144);
 /* General Evaluation Terms */
 
 const int Tempo = 20;
+const int LazyMargin = 600;
+
+// Colour parallel terms are used unless disabled, as by the evaldiff tool
+int ColourParallelEval = 1;
 
 #undef S
 
-int evaluateBoard(Board *board, PKTable *pktable, int contempt) {
+int evaluateBoard(Thread *thread, Board *board) {
 
     EvalInfo ei;
-    int phase, factor, eval, pkeval;
+    MaterialEntry material, *mentry;
+    int phase, factor, scale, eval, pkeval;
+
+    // Threads provide caching and contempt. Without one, as when tuning, we
+    // evaluate from scratch with neither, so that every term is traced
+    PKTable *pktable       = thread == NULL || thread->pktable.buckets == NULL ? NULL : &thread->pktable;
+    MaterialTable *mtable  = thread == NULL ? NULL : &thread->mtable;
+    EvalCache *cache       = thread == NULL ? NULL : &thread->evalCache;
+    int contempt           = thread == NULL ? 0    :  thread->contempt;
+
+    // Positions recur often via transpositions, especially in qsearch
+    if (cache != NULL && cache->entries != NULL && getEvalCacheEntry(cache, board->hash, &eval))
+        return eval;
+
+    // The game phase, the scale factors, and any specialised endgame depend
+    // on the material alone, so we look them up by the material key
+    mentry = mtable == NULL ? NULL : getMaterialEntry(mtable, board->materialKey);
+    if (mentry == NULL) {
+        evaluateMaterial(&material, board);
+        if (mtable != NULL) storeMaterialEntry(mtable, &material);
+        mentry = &material;
+    }
+
+    // Trivial endgames are given a specialised evaluation instead of the full
+    // one. These are relative to the side to move, and have no contempt. The
+    // Tempo is still added, as the search relies on it around null moves
+    if (!TRACE && mentry->endgame && Endgames[mentry->endgame].type == ENDGAME_EVAL) {
+        eval = evaluateEndgame(board, mentry->endgame) + Tempo;
+        if (thread != NULL && endgameProbesKPK(mentry->endgame))
+            thread->kpkProbes++;
+        if (cache != NULL && cache->entries != NULL)
+            storeEvalCacheEntry(cache, board->hash, eval);
+        return eval;
+    }
+
+    // Boards which carry NNUE accumulators are evaluated by the network alone.
+    // Its output is already relative to the side to move, and has no contempt.
+    // We add the Tempo as above, and keep a bad network out of the TB scores
+    if (board->accumulator != NULL) {
+        eval = nnueEvaluate(board) + Tempo;
+        eval = MAX(-TBWIN_IN_MAX + 1, MIN(TBWIN_IN_MAX - 1, eval));
+        if (cache != NULL && cache->entries != NULL)
+            storeEvalCacheEntry(cache, board->hash, eval);
+        return eval;
+    }
 
     // Setup and perform all evaluations
     initEvalInfo(&ei, board, pktable);
@@ -371,15 +422,14 @@ int evaluateBoard(Board *board, PKTable *pktable, int contempt) {
     eval  += evaluateClosedness(&ei, board);
     eval  += evaluateComplexity(&ei, board, eval);
 
-    // Calculate the game phase based on remaining material (Fruit Method)
-    phase = 24 - 4 * popcount(board->pieces[QUEEN ])
-               - 2 * popcount(board->pieces[ROOK  ])
-               - 1 * popcount(board->pieces[KNIGHT]
-                             |board->pieces[BISHOP]);
-    phase = (phase * 256 + 12) / 24;
+    // Scale evaluation based on remaining material and the stronger side
+    phase  = mentry->phase;
+    factor = mentry->scale[ScoreEG(eval) < 0 ? BLACK : WHITE];
 
-    // Scale evaluation based on remaining material
-    factor = evaluateScaleFactor(board, eval);
+    // Some endgames refine the scale factor by looking at the position
+    if (   !TRACE && mentry->endgame && Endgames[mentry->endgame].type == ENDGAME_SCALE
+        && (scale = scaleEndgame(board, mentry->endgame, ScoreEG(eval) < 0 ? BLACK : WHITE)) != SCALE_NONE)
+        factor = scale;
 
     // Compute the interpolated and scaled evaluation
     eval = (ScoreMG(eval) * (256 - phase)
@@ -395,7 +445,54 @@ int evaluateBoard(Board *board, PKTable *pktable, int contempt) {
         storePKEntry(pktable, board->pkhash, ei.passedPawns, pkeval);
 
     // Return the evaluation relative to the side to move
-    return board->turn == WHITE ? eval : -eval;
+    eval = board->turn == WHITE ? eval : -eval;
+
+    // Save the final evaluation for any later visits to the position
+    if (cache != NULL && cache->entries != NULL)
+        storeEvalCacheEntry(cache, board->hash, eval);
+
+    return eval;
+}
+
+int evaluateBoardLazy(Thread *thread, Board *board, int alpha, int beta) {
+
+    PKEntry *pkentry;
+    MaterialEntry *mentry;
+    int phase, factor, eval;
+
+    // The estimate is built from classical terms, so the network must run
+    if (board->accumulator != NULL)
+        return evaluateBoard(thread, board);
+
+    // A cached evaluation is exact, and cheaper than any estimate
+    if (thread->evalCache.entries != NULL && getEvalCacheEntry(&thread->evalCache, board->hash, &eval))
+        return eval;
+
+    // The estimate needs both the hashed Pawn King Eval and the hashed
+    // Material Entry. Without them there is nothing cheap to work with, and
+    // specialised endgames are already cheap enough to evaluate exactly
+    pkentry = thread->pktable.buckets == NULL ? NULL : getPKEntry(&thread->pktable, board->pkhash);
+    mentry  = getMaterialEntry(&thread->mtable, board->materialKey);
+    if (pkentry == NULL || mentry == NULL || mentry->endgame)
+        return evaluateBoard(thread, board);
+
+    // Estimate using only the material, PSQT, and Pawn King terms
+    eval   = board->psqtmat + pkentry->eval + thread->contempt;
+    phase  = mentry->phase;
+    factor = mentry->scale[ScoreEG(eval) < 0 ? BLACK : WHITE];
+
+    // Interpolate, scale, and add the Tempo exactly as evaluateBoard() does
+    eval = (ScoreMG(eval) * (256 - phase)
+         +  ScoreEG(eval) * phase * factor / SCALE_NORMAL) / 256;
+    eval += board->turn == WHITE ? Tempo : -Tempo;
+    eval  = board->turn == WHITE ? eval : -eval;
+
+    // The remaining terms are unlikely to move the estimate by more than
+    // the LazyMargin, so if it is that far outside the window, we trust it
+    if (eval - LazyMargin >= beta || eval + LazyMargin <= alpha)
+        return eval;
+
+    return evaluateBoard(thread, board);
 }
 
 int evaluatePieces(EvalInfo *ei, Board *board) {
@@ -409,8 +506,18 @@ int evaluatePieces(EvalInfo *ei, Board *board) {
     eval +=  evaluateQueens(ei, board, WHITE)  - evaluateQueens(ei, board, BLACK);
     eval +=   evaluateKings(ei, board, WHITE)   - evaluateKings(ei, board, BLACK);
     eval +=  evaluatePassed(ei, board, WHITE)  - evaluatePassed(ei, board, BLACK);
-    eval += evaluateThreats(ei, board, WHITE) - evaluateThreats(ei, board, BLACK);
-    eval +=   evaluateSpace(ei, board, WHITE) -   evaluateSpace(ei, board, BLACK);
+
+    // Threats and Space run the same bitboard algebra for each colour, so
+    // outside of tuning we evaluate both colours at once in vector lanes
+    if (!TRACE && ColourParallelEval) {
+        eval += evaluateThreatsPaired(ei, board);
+        eval +=   evaluateSpacePaired(ei, board);
+    }
+
+    else {
+        eval += evaluateThreats(ei, board, WHITE) - evaluateThreats(ei, board, BLACK);
+        eval +=   evaluateSpace(ei, board, WHITE) -   evaluateSpace(ei, board, BLACK);
+    }
 
     return eval;
 }
@@ -529,7 +636,11 @@ int evaluateKnights(EvalInfo *ei, Board *board, int colour) {
         if (TRACE) T.KnightPSQT32[relativeSquare32(US, sq)][US]++;
 
         // Compute possible attacks and store off information for king safety
+#ifdef USE_ATTACK_MAPS
+        attacks = board->attacks[sq];
+#else
         attacks = knightAttacks(sq);
+#endif
         ei->attackedBy2[US]        |= attacks & ei->attacked[US];
         ei->attacked[US]           |= attacks;
         ei->attackedBy[US][KNIGHT] |= attacks;
@@ -729,7 +840,11 @@ int evaluateQueens(EvalInfo *ei, Board *board, int colour) {
         if (TRACE) T.QueenPSQT32[relativeSquare32(US, sq)][US]++;
 
         // Compute possible attacks and store off information for king safety
+#ifdef USE_ATTACK_MAPS
+        attacks = board->attacks[sq];
+#else
         attacks = queenAttacks(sq, board->colours[WHITE] | board->colours[BLACK]);
+#endif
         ei->attackedBy2[US]       |= attacks & ei->attacked[US];
         ei->attacked[US]          |= attacks;
         ei->attackedBy[US][QUEEN] |= attacks;
@@ -1037,9 +1152,132 @@ int evaluateSpace(EvalInfo *ei, Board *board, int colour) {
     return eval;
 }
 
+/* Colour Parallel Evaluation */
+
+// Lane 0 holds a bitboard from White's point of view, and lane 1 from Black's
+typedef uint64_t ColourBB __attribute__((vector_size(16)));
+
+static inline ColourBB cbbMake(uint64_t white, uint64_t black) {
+    return (ColourBB) { white, black };
+}
+
+static inline ColourBB cbbSplat(uint64_t bb) {
+    return (ColourBB) { bb, bb };
+}
+
+static inline ColourBB cbbSwap(ColourBB bbs) {
+    return (ColourBB) { bbs[BLACK], bbs[WHITE] };
+}
+
+static inline int cbbPopcountDiff(ColourBB bbs) {
+    return popcount(bbs[WHITE]) - popcount(bbs[BLACK]);
+}
+
+static inline ColourBB cbbPawnAdvance(ColourBB pawns, ColourBB occupied) {
+    return ~occupied & ((pawns << (ColourBB) { 8, 0 }) >> (ColourBB) { 0, 8 });
+}
+
+static inline ColourBB cbbPawnAttackSpan(ColourBB pawns, ColourBB targets) {
+    ColourBB left  = (pawns << (ColourBB) { 7, 0 }) >> (ColourBB) { 0, 7 };
+    ColourBB right = (pawns << (ColourBB) { 9, 0 }) >> (ColourBB) { 0, 9 };
+    return targets & (  (left  & cbbMake(~FILE_H, ~FILE_A))
+                      | (right & cbbMake(~FILE_A, ~FILE_H)));
+}
+
+int evaluateThreatsPaired(EvalInfo *ei, Board *board) {
+
+    // Matches evaluateThreats(WHITE) - evaluateThreats(BLACK) exactly. Each
+    // ColourBB is from the point of view of the lane's colour, and swapping
+    // the lanes gives the same bitboard from the point of view of the enemy
+
+    int eval = 0;
+
+    ColourBB friendly = cbbMake(board->colours[WHITE], board->colours[BLACK]);
+    ColourBB enemy    = cbbSwap(friendly);
+    ColourBB occupied = friendly | enemy;
+
+    ColourBB pawns   = friendly & cbbSplat(board->pieces[PAWN  ]);
+    ColourBB knights = friendly & cbbSplat(board->pieces[KNIGHT]);
+    ColourBB bishops = friendly & cbbSplat(board->pieces[BISHOP]);
+    ColourBB rooks   = friendly & cbbSplat(board->pieces[ROOK  ]);
+    ColourBB queens  = friendly & cbbSplat(board->pieces[QUEEN ]);
+
+    ColourBB attacked        = cbbMake(ei->attacked[WHITE], ei->attacked[BLACK]);
+    ColourBB attackedBy2     = cbbMake(ei->attackedBy2[WHITE], ei->attackedBy2[BLACK]);
+    ColourBB attackedByPawns = cbbMake(ei->attackedBy[WHITE][PAWN], ei->attackedBy[BLACK][PAWN]);
+    ColourBB enemyAttacked   = cbbSwap(attacked);
+    ColourBB enemyAttackBy2  = cbbSwap(attackedBy2);
+
+    ColourBB attacksByPawns  = cbbSwap(attackedByPawns);
+    ColourBB attacksByKing   = cbbMake(ei->attackedBy[BLACK][KING], ei->attackedBy[WHITE][KING]);
+    ColourBB attacksByMinors = cbbMake(ei->attackedBy[BLACK][KNIGHT] | ei->attackedBy[BLACK][BISHOP],
+                                       ei->attackedBy[WHITE][KNIGHT] | ei->attackedBy[WHITE][BISHOP]);
+    ColourBB attacksByMajors = cbbMake(ei->attackedBy[BLACK][ROOK  ] | ei->attackedBy[BLACK][QUEEN ],
+                                       ei->attackedBy[WHITE][ROOK  ] | ei->attackedBy[WHITE][QUEEN ]);
+
+    // Squares with more attackers, few defenders, and no pawn support
+    ColourBB poorlyDefended = (enemyAttacked & ~attacked)
+                            | (enemyAttackBy2 & ~attackedBy2 & ~attackedByPawns);
+
+    ColourBB weakMinors = (knights | bishops) & poorlyDefended;
+
+    // A friendly minor or major is overloaded if attacked and defended by exactly one
+    ColourBB overloaded = (knights | bishops | rooks | queens)
+                        & attacked      & ~attackedBy2
+                        & enemyAttacked & ~enemyAttackBy2;
+
+    // Look for enemy non-pawn pieces which we may threaten with a safe pawn advance
+    ColourBB pushThreat  = cbbPawnAdvance(pawns, occupied);
+    pushThreat |= cbbPawnAdvance(pushThreat & ~attacksByPawns & cbbMake(RANK_3, RANK_6), occupied);
+    pushThreat &= ~attacksByPawns & (attacked | ~enemyAttacked);
+    pushThreat  = cbbPawnAttackSpan(pushThreat, enemy & ~attackedByPawns);
+
+    eval += cbbPopcountDiff(pawns & ~attacksByPawns & poorlyDefended) * ThreatWeakPawn;
+    eval += cbbPopcountDiff((knights | bishops) & attacksByPawns)     * ThreatMinorAttackedByPawn;
+    eval += cbbPopcountDiff((knights | bishops) & attacksByMinors)    * ThreatMinorAttackedByMinor;
+    eval += cbbPopcountDiff(weakMinors & attacksByMajors)             * ThreatMinorAttackedByMajor;
+    eval += cbbPopcountDiff(rooks & (attacksByPawns | attacksByMinors)) * ThreatRookAttackedByLesser;
+    eval += cbbPopcountDiff(weakMinors & attacksByKing)               * ThreatMinorAttackedByKing;
+    eval += cbbPopcountDiff(rooks & poorlyDefended & attacksByKing)   * ThreatRookAttackedByKing;
+    eval += cbbPopcountDiff(queens & enemyAttacked)                   * ThreatQueenAttackedByOne;
+    eval += cbbPopcountDiff(overloaded)                               * ThreatOverloadedPieces;
+    eval += cbbPopcountDiff(pushThreat)                               * ThreatByPawnPush;
+
+    return eval;
+}
+
+int evaluateSpacePaired(EvalInfo *ei, Board *board) {
+
+    // Matches evaluateSpace(WHITE) - evaluateSpace(BLACK) exactly
+
+    int eval = 0;
+
+    ColourBB friendly = cbbMake(board->colours[WHITE], board->colours[BLACK]);
+    ColourBB occupied = friendly | cbbSwap(friendly);
+
+    ColourBB attacked        = cbbMake(ei->attacked[WHITE], ei->attacked[BLACK]);
+    ColourBB attackedBy2     = cbbMake(ei->attackedBy2[WHITE], ei->attackedBy2[BLACK]);
+    ColourBB attackedByPawns = cbbMake(ei->attackedBy[WHITE][PAWN], ei->attackedBy[BLACK][PAWN]);
+
+    // Squares we attack with more enemy attackers and no friendly pawn attacks
+    ColourBB uncontrolled = cbbSwap(attackedBy2) & attacked & ~attackedBy2 & ~attackedByPawns;
+
+    eval += cbbPopcountDiff(uncontrolled &  occupied) * SpaceRestrictPiece;
+    eval += cbbPopcountDiff(uncontrolled & ~occupied) * SpaceRestrictEmpty;
+
+    // Bonus for uncontested central squares, only with enough minors and majors
+    if (      popcount(board->pieces[KNIGHT] | board->pieces[BISHOP])
+        + 2 * popcount(board->pieces[ROOK  ] | board->pieces[QUEEN ]) > 12) {
+        ColourBB uncontested = ~cbbSwap(attacked) & (attacked | friendly) & cbbSplat(CENTER_BIG);
+        eval += cbbPopcountDiff(uncontested) * SpaceCenterControl;
+    }
+
+    return eval;
+}
+
 int evaluateClosedness(EvalInfo *ei, Board *board) {
 
-    int closedness, count, eval = 0;
+    int closedness = ei->closedness, count, eval = 0;
 
     uint64_t white = board->colours[WHITE];
     uint64_t black = board->colours[BLACK];
@@ -1047,12 +1285,6 @@ int evaluateClosedness(EvalInfo *ei, Board *board) {
     uint64_t knights = board->pieces[KNIGHT];
     uint64_t rooks   = board->pieces[ROOK  ];
 
-    // Compute Closedness factor for this position
-    closedness = 1 * popcount(board->pieces[PAWN])
-               + 3 * popcount(ei->rammedPawns[WHITE])
-               - 4 * openFileCount(board->pieces[PAWN]);
-    closedness = MAX(0, MIN(8, closedness / 3));
-
     // Evaluate Knights based on how Closed the position is
     count = popcount(white & knights) - popcount(black & knights);
     eval += count * ClosednessKnightAdjustment[closedness];
@@ -1103,7 +1335,26 @@ int evaluateComplexity(EvalInfo *ei, Board *board, int eval) {
     return MakeScore(0, v);
 }
 
-int evaluateScaleFactor(Board *board, int eval) {
+void evaluateMaterial(MaterialEntry *mentry, Board *board) {
+
+    mentry->key = board->materialKey;
+
+    // Calculate the game phase based on remaining material (Fruit Method)
+    int phase = 24 - 4 * popcount(board->pieces[QUEEN ])
+                   - 2 * popcount(board->pieces[ROOK  ])
+                   - 1 * popcount(board->pieces[KNIGHT]
+                                 |board->pieces[BISHOP]);
+    mentry->phase = (phase * 256 + 12) / 24;
+
+    // Scale factors for either side being the one ahead in the endgame
+    mentry->scale[WHITE] = evaluateScaleFactor(board, WHITE);
+    mentry->scale[BLACK] = evaluateScaleFactor(board, BLACK);
+
+    // Trivial endgames may have specialised evaluation or scaling functions
+    mentry->endgame = findEndgame(board->materialKey);
+}
+
+int evaluateScaleFactor(Board *board, int strongSide) {
 
     // Scale endgames based upon the remaining material. We check
     // for various Opposite Coloured Bishop cases, positions with
@@ -1122,8 +1373,8 @@ int evaluateScaleFactor(Board *board, int eval) {
     const uint64_t white   = board->colours[WHITE];
     const uint64_t black   = board->colours[BLACK];
 
-    const uint64_t weak    = ScoreEG(eval) < 0 ? white : black;
-    const uint64_t strong  = ScoreEG(eval) < 0 ? black : white;
+    const uint64_t weak    = strongSide == WHITE ? black : white;
+    const uint64_t strong  = strongSide == WHITE ? white : black;
 
 
     // Check for opposite coloured bishops
@@ -1176,6 +1427,12 @@ void initEvalInfo(EvalInfo *ei, Board *board, PKTable *pktable) {
     uint64_t rooks   = board->pieces[ROOK  ] | board->pieces[QUEEN];
     uint64_t kings   = board->pieces[KING  ];
 
+    // Try to read a hashed Pawn King Eval. Otherwise, start from scratch
+    ei->pkentry       =     pktable == NULL ? NULL : getPKEntry(pktable, board->pkhash);
+    ei->passedPawns   = ei->pkentry == NULL ? 0ull : ei->pkentry->passed;
+    ei->pkeval[WHITE] = ei->pkentry == NULL ? 0    : ei->pkentry->eval;
+    ei->pkeval[BLACK] = ei->pkentry == NULL ? 0    : 0;
+
     // Save some general information about the pawn structure for later
     ei->pawnAttacks[WHITE]    = pawnAttackSpan(white & pawns, ~0ull, WHITE);
     ei->pawnAttacks[BLACK]    = pawnAttackSpan(black & pawns, ~0ull, BLACK);
@@ -1183,15 +1440,23 @@ void initEvalInfo(EvalInfo *ei, Board *board, PKTable *pktable) {
     ei->pawnAttacksBy2[BLACK] = pawnAttackDouble(black & pawns, ~0ull, BLACK);
     ei->rammedPawns[WHITE]    = pawnAdvance(black & pawns, ~(white & pawns), BLACK);
     ei->rammedPawns[BLACK]    = pawnAdvance(white & pawns, ~(black & pawns), WHITE);
-    ei->blockedPawns[WHITE]   = pawnAdvance(white | black, ~(white & pawns), BLACK);
-    ei->blockedPawns[BLACK]   = pawnAdvance(white | black, ~(black & pawns), WHITE);
+
+    // Compute Closedness factor for this position
+    ei->closedness = 1 * popcount(pawns)
+                   + 3 * popcount(ei->rammedPawns[WHITE])
+                   - 4 * openFileCount(pawns);
+    ei->closedness = MAX(0, MIN(8, ei->closedness / 3));
 
     // Compute an area for evaluating our King's safety.
     // The definition of the King Area can be found in masks.c
     ei->kingSquare[WHITE] = getlsb(white & kings);
     ei->kingSquare[BLACK] = getlsb(black & kings);
-    ei->kingAreas[WHITE] = kingAreaMasks(WHITE, ei->kingSquare[WHITE]);
-    ei->kingAreas[BLACK] = kingAreaMasks(BLACK, ei->kingSquare[BLACK]);
+    ei->kingAreas[WHITE]  = kingAreaMasks(WHITE, ei->kingSquare[WHITE]);
+    ei->kingAreas[BLACK]  = kingAreaMasks(BLACK, ei->kingSquare[BLACK]);
+
+    // Blocked pawns depend on every piece, not just the pawns
+    ei->blockedPawns[WHITE]   = pawnAdvance(white | black, ~(white & pawns), BLACK);
+    ei->blockedPawns[BLACK]   = pawnAdvance(white | black, ~(black & pawns), WHITE);
 
     // Exclude squares attacked by our opponents, our blocked pawns, and our own King
     ei->mobilityAreas[WHITE] = ~(ei->pawnAttacks[BLACK] | (white & kings) | ei->blockedPawns[WHITE]);
@@ -1199,8 +1464,13 @@ void initEvalInfo(EvalInfo *ei, Board *board, PKTable *pktable) {
 
     // Init part of the attack tables. By doing this step here, evaluatePawns()
     // can start by setting up the attackedBy2 table, since King attacks are resolved
+#ifdef USE_ATTACK_MAPS
+    ei->attacked[WHITE] = ei->attackedBy[WHITE][KING] = board->attacks[ei->kingSquare[WHITE]];
+    ei->attacked[BLACK] = ei->attackedBy[BLACK][KING] = board->attacks[ei->kingSquare[BLACK]];
+#else
     ei->attacked[WHITE] = ei->attackedBy[WHITE][KING] = kingAttacks(ei->kingSquare[WHITE]);
     ei->attacked[BLACK] = ei->attackedBy[BLACK][KING] = kingAttacks(ei->kingSquare[BLACK]);
+#endif
 
     // For mobility, we allow bishops to attack through each other
     ei->occupiedMinusBishops[WHITE] = (white | black) ^ (white & bishops);
@@ -1214,12 +1484,6 @@ void initEvalInfo(EvalInfo *ei, Board *board, PKTable *pktable) {
     ei->kingAttacksCount[WHITE]    = ei->kingAttacksCount[BLACK]    = 0;
     ei->kingAttackersCount[WHITE]  = ei->kingAttackersCount[BLACK]  = 0;
     ei->kingAttackersWeight[WHITE] = ei->kingAttackersWeight[BLACK] = 0;
-
-    // Try to read a hashed Pawn King Eval. Otherwise, start from scratch
-    ei->pkentry       =     pktable == NULL ? NULL : getPKEntry(pktable, board->pkhash);
-    ei->passedPawns   = ei->pkentry == NULL ? 0ull : ei->pkentry->passed;
-    ei->pkeval[WHITE] = ei->pkentry == NULL ? 0    : ei->pkentry->eval;
-    ei->pkeval[BLACK] = ei->pkentry == NULL ? 0    : 0;
 }
 
 void initEval() {
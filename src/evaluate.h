@@ -112,6 +112,7 @@ struct EvalInfo {
     uint64_t occupiedMinusBishops[COLOUR_NB];
     uint64_t occupiedMinusRooks[COLOUR_NB];
     uint64_t passedPawns;
+    int closedness;
     int kingSquare[COLOUR_NB];
     int kingAttacksCount[COLOUR_NB];
     int kingAttackersCount[COLOUR_NB];
@@ -120,7 +121,8 @@ struct EvalInfo {
     PKEntry *pkentry;
 };
 
-int evaluateBoard(Board *board, PKTable *pktable, int contempt);
+int evaluateBoard(Thread *thread, Board *board);
+int evaluateBoardLazy(Thread *thread, Board *board, int alpha, int beta);
 int evaluatePieces(EvalInfo *ei, Board *board);
 int evaluatePawns(EvalInfo *ei, Board *board, int colour);
 int evaluateKnights(EvalInfo *ei, Board *board, int colour);
@@ -131,9 +133,12 @@ int evaluateKings(EvalInfo *ei, Board *board, int colour);
 int evaluatePassed(EvalInfo *ei, Board *board, int colour);
 int evaluateThreats(EvalInfo *ei, Board *board, int colour);
 int evaluateSpace(EvalInfo *ei, Board *board, int colour);
+int evaluateThreatsPaired(EvalInfo *ei, Board *board);
+int evaluateSpacePaired(EvalInfo *ei, Board *board);
 int evaluateClosedness(EvalInfo *ei, Board *board);
 int evaluateComplexity(EvalInfo *ei, Board *board, int eval);
-int evaluateScaleFactor(Board *board, int eval);
+void evaluateMaterial(MaterialEntry *mentry, Board *board);
+int evaluateScaleFactor(Board *board, int strongSide);
 void initEvalInfo(EvalInfo *ei, Board *board, PKTable *pktable);
 void initEval();
 
@@ -142,4 +147,5 @@ void initEval();
 #define ScoreEG(s) ((int16_t)((uint16_t)((unsigned)((s) + 0x8000) >> 16)))
 
 extern int PSQT[32][SQUARE_NB];
+extern const int PawnValue, KnightValue, BishopValue, RookValue, QueenValue;
 extern const int Tempo;
@@ -36,6 +36,7 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #ifndef _WIN32
+#include <sched.h>
 #include <unistd.h>
 #include <sys/mman.h>
 #endif
@@ -49,6 +50,9 @@
 
 #define TBMAX_PIECE 254
 #define TBMAX_PAWN 256
+#define TBMAX_CANDIDATE (TBMAX_PIECE + TBMAX_PAWN)
+#define TBINIT_THREADS 32
+#define TBINDEX_VERSION "fathom-index 1"
 #define HSHMAX 5
 
 // for variants where kings can connect and/or captured
@@ -91,12 +95,26 @@ static int TBnum_piece, TBnum_pawn;
 static struct TBEntry_piece TB_piece[TBMAX_PIECE];
 static struct TBEntry_pawn TB_pawn[TBMAX_PAWN];
 
+// file names of the registered tables, kept for preloading
+static char TB_piece_name[TBMAX_PIECE][16];
+static char TB_pawn_name[TBMAX_PAWN][16];
+
+// every table name which could exist, and the size of those found
+static int TBnum_candidate, TBnext_candidate;
+static char TB_candidate[TBMAX_CANDIDATE][16];
+static uint64 TB_candidate_size[TBMAX_CANDIDATE];
+
 static struct TBHashEntry TB_hash[1 << TBHASHBITS][HSHMAX];
 
 #define DTZ_ENTRIES 64
 
 static struct DTZTableEntry DTZ_table[DTZ_ENTRIES];
 
+// states of the ready flag of a WDL table
+#define TB_UNMAPPED 0
+#define TB_MAPPING  1
+#define TB_MAPPED   2
+
 static void init_indices(void);
 static uint64_t calc_key_from_pcs(int *pcs, int mirror);
 static void free_wdl_entry(struct TBEntry *entry);
@@ -228,19 +246,14 @@ static void add_to_hash(struct TBEntry *ptr, uint64 key)
 
 static char pchr[] = {'K', 'Q', 'R', 'B', 'N', 'P'};
 
-static void init_tb(char *str)
+static void register_tb(char *str)
 {
-  FD fd;
   struct TBEntry *entry;
   int i, j, pcs[16];
   uint64 key, key2;
   int color;
   char *s;
 
-  fd = open_tb(str, WDLSUFFIX);
-  if (fd == FD_ERR) return;
-  close_tb(fd);
-
   for (i = 0; i < 16; i++)
     pcs[i] = 0;
   color = 0;
@@ -275,17 +288,19 @@ static void init_tb(char *str)
       fprintf(stderr,"TBMAX_PIECE limit too low!\n");
       exit(1);
     }
+    strcpy(TB_piece_name[TBnum_piece], str);
     entry = (struct TBEntry *)&TB_piece[TBnum_piece++];
   } else {
     if (TBnum_pawn == TBMAX_PAWN) {
       fprintf(stderr,"TBMAX_PAWN limit too low!\n");
       exit(1);
     }
+    strcpy(TB_pawn_name[TBnum_pawn], str);
     entry = (struct TBEntry *)&TB_pawn[TBnum_pawn++];
   }
 
   entry->key = key;
-  entry->ready = 0;
+  entry->ready = TB_UNMAPPED;
   entry->num = 0;
   for (i = 0; i < 16; i++)
     entry->num += pcs[i];
@@ -321,10 +336,148 @@ static void init_tb(char *str)
   if (key2 != key) add_to_hash(entry, key2);
 }
 
-void init_tablebases(const char *path)
+static void add_candidate(const char *str)
+{
+  strcpy(TB_candidate[TBnum_candidate++], str);
+}
+
+// Returns the size of a WDL table, or zero if it is missing or its
+// header does not carry the WDL magic
+static uint64 check_tb(const char *str)
+{
+  FD fd = open_tb(str, WDLSUFFIX);
+  if (fd == FD_ERR)
+    return 0;
+#ifndef _WIN32
+  struct stat statbuf;
+  uint32 magic = 0;
+  uint64 size = 0;
+  if (!fstat(fd, &statbuf) && read(fd, &magic, sizeof(magic)) == sizeof(magic)
+      && magic == WDL_MAGIC)
+    size = statbuf.st_size;
+  close_tb(fd);
+  return size;
+#else
+  DWORD size_low, size_high;
+  size_low = GetFileSize(fd, &size_high);
+  close_tb(fd);
+  return ((uint64)size_high) << 32 | ((uint64)size_low);
+#endif
+}
+
+#ifndef _WIN32
+static void *discover_worker(void *arg)
+{
+  int i;
+  (void)arg;
+  while ((i = __atomic_fetch_add(&TBnext_candidate, 1, __ATOMIC_RELAXED)) < TBnum_candidate)
+    TB_candidate_size[i] = check_tb(TB_candidate[i]);
+  return NULL;
+}
+#endif
+
+// Look for every candidate table. Each lookup is a few round trips to the
+// file system, so on network storage they are spread over many threads
+static void discover_tables(void)
+{
+  int i;
+#ifndef _WIN32
+  pthread_t threads[TBINIT_THREADS];
+  int started = 0;
+
+  TBnext_candidate = 0;
+  for (i = 0; i < TBINIT_THREADS; i++)
+    if (!pthread_create(&threads[i], NULL, discover_worker, NULL))
+      started++;
+    else
+      break;
+  discover_worker(NULL);
+  for (i = 0; i < started; i++)
+    pthread_join(threads[i], NULL);
+#else
+  for (i = 0; i < TBnum_candidate; i++)
+    TB_candidate_size[i] = check_tb(TB_candidate[i]);
+#endif
+}
+
+static long long dir_mtime(const char *dir)
+{
+  struct stat statbuf;
+  if (stat(dir, &statbuf))
+    return -1;
+#if defined(__APPLE__)
+  return statbuf.st_mtimespec.tv_sec * 1000000000LL + statbuf.st_mtimespec.tv_nsec;
+#elif !defined(_WIN32)
+  return statbuf.st_mtim.tv_sec * 1000000000LL + statbuf.st_mtim.tv_nsec;
+#else
+  return (long long)statbuf.st_mtime;
+#endif
+}
+
+// The index lists the tables found and their sizes, for the same path
+// string, and is only trusted while no directory has been modified since
+static int read_index(const char *index, const long long *mtimes)
+{
+  FILE *fin = fopen(index, "r");
+  char line[1024], expect[1024], name[16];
+  unsigned long long size;
+  int i, valid = 0;
+
+  if (!fin)
+    return 0;
+
+  for (i = 0; i < TBnum_candidate; i++)
+    TB_candidate_size[i] = 0;
+
+  if (!fgets(line, sizeof(line), fin) || strcmp(line, TBINDEX_VERSION "\n"))
+    goto done;
+
+  for (i = 0; i < num_paths; i++) {
+    snprintf(expect, sizeof(expect), "%lld %s\n", mtimes[i], paths[i]);
+    if (!fgets(line, sizeof(line), fin) || strcmp(line, expect))
+      goto done;
+  }
+
+  while (fgets(line, sizeof(line), fin)) {
+    if (sscanf(line, "%15s %llu", name, &size) != 2)
+      goto done;
+    for (i = 0; i < TBnum_candidate; i++)
+      if (!strcmp(name, TB_candidate[i]))
+        TB_candidate_size[i] = size;
+  }
+  valid = 1;
+
+done:
+  fclose(fin);
+  return valid;
+}
+
+static void write_index(const char *index, const long long *mtimes)
+{
+  char tmp[1024];
+  FILE *fout;
+  int i;
+
+  // written aside and renamed, so a reader never sees half of an index
+  snprintf(tmp, sizeof(tmp), "%s.tmp", index);
+  if (!(fout = fopen(tmp, "w")))
+    return;
+
+  fprintf(fout, TBINDEX_VERSION "\n");
+  for (i = 0; i < num_paths; i++)
+    fprintf(fout, "%lld %s\n", mtimes[i], paths[i]);
+  for (i = 0; i < TBnum_candidate; i++)
+    if (TB_candidate_size[i])
+      fprintf(fout, "%s %llu\n", TB_candidate[i], (unsigned long long)TB_candidate_size[i]);
+
+  if (fclose(fout) || rename(tmp, index))
+    remove(tmp);
+}
+
+void init_tablebases(const char *path, const char *index)
 {
   char str[16];
-  int i, j, k, l;
+  int i, j, k, l, indexed = 0;
 
   if (initialized) {
     free(path_string);
@@ -380,35 +533,37 @@ void init_tablebases(const char *path)
   for (i = 0; i < DTZ_ENTRIES; i++)
     DTZ_table[i].entry = NULL;
 
+  TBnum_candidate = 0;
+
   for (i = 1; i < 6; i++) {
     sprintf(str, "K%cvK", pchr[i]);
-    init_tb(str);
+    add_candidate(str);
   }
 
   for (i = 1; i < 6; i++)
     for (j = i; j < 6; j++) {
       sprintf(str, "K%cvK%c", pchr[i], pchr[j]);
-      init_tb(str);
+      add_candidate(str);
     }
 
   for (i = 1; i < 6; i++)
     for (j = i; j < 6; j++) {
       sprintf(str, "K%c%cvK", pchr[i], pchr[j]);
-      init_tb(str);
+      add_candidate(str);
     }
 
   for (i = 1; i < 6; i++)
     for (j = i; j < 6; j++)
       for (k = 1; k < 6; k++) {
 	sprintf(str, "K%c%cvK%c", pchr[i], pchr[j], pchr[k]);
-	init_tb(str);
+	add_candidate(str);
       }
 
   for (i = 1; i < 6; i++)
     for (j = i; j < 6; j++)
       for (k = j; k < 6; k++) {
 	sprintf(str, "K%c%c%cvK", pchr[i], pchr[j], pchr[k]);
-	init_tb(str);
+	add_candidate(str);
       }
 
   for (i = 1; i < 6; i++)
@@ -416,7 +571,7 @@ void init_tablebases(const char *path)
       for (k = i; k < 6; k++)
 	for (l = (i == k) ? j : k; l < 6; l++) {
 	  sprintf(str, "K%c%cvK%c%c", pchr[i], pchr[j], pchr[k], pchr[l]);
-	  init_tb(str);
+	  add_candidate(str);
 	}
 
   for (i = 1; i < 6; i++)
@@ -424,7 +579,7 @@ void init_tablebases(const char *path)
       for (k = j; k < 6; k++)
 	for (l = 1; l < 6; l++) {
 	  sprintf(str, "K%c%c%cvK%c", pchr[i], pchr[j], pchr[k], pchr[l]);
-	  init_tb(str);
+	  add_candidate(str);
 	}
 
   for (i = 1; i < 6; i++)
@@ -432,10 +587,31 @@ void init_tablebases(const char *path)
       for (k = j; k < 6; k++)
 	for (l = k; l < 6; l++) {
 	  sprintf(str, "K%c%c%c%cvK", pchr[i], pchr[j], pchr[k], pchr[l]);
-	  init_tb(str);
+	  add_candidate(str);
 	}
 
-  printf("info string found %d tablebases\n", TBnum_piece + TBnum_pawn);
+  // look for the candidates on disk, unless the index is still valid, and
+  // then register those found in the order they were listed. The times are
+  // taken first, so that a table added during the search dirties the index
+  long long *mtimes = (long long *)malloc(num_paths * sizeof(long long));
+  for (i = 0; i < num_paths; i++)
+    mtimes[i] = dir_mtime(paths[i]);
+
+  if (index && *index && read_index(index, mtimes))
+    indexed = 1;
+  else {
+    discover_tables();
+    if (index && *index)
+      write_index(index, mtimes);
+  }
+  free(mtimes);
+
+  for (i = 0; i < TBnum_candidate; i++)
+    if (TB_candidate_size[i])
+      register_tb(TB_candidate[i]);
+
+  printf("info string found %d tablebases%s\n", TBnum_piece + TBnum_pawn,
+         indexed ? " in the index" : "");
 }
 
 static const signed char offdiag[] = {
@@ -1685,6 +1861,121 @@ static void free_wdl_entry(struct TBEntry *entry)
   }
 }
 
+// Map a WDL table on its first use. The first thread to need the table
+// claims it and maps it, while any others needing the same table wait for
+// it to be published. There is no global lock, so threads entering
+// different new endings never wait on each other.
+static int init_table_wdl_once(struct TBEntry *entry, char *str)
+{
+  ubyte state = TB_UNMAPPED;
+
+  if (__atomic_load_n(&entry->ready, __ATOMIC_ACQUIRE) == TB_MAPPED)
+    return 1;
+
+  if (__atomic_compare_exchange_n(&entry->ready, &state, TB_MAPPING, 0,
+                                  __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+    int success = init_table_wdl(entry, str);
+    __atomic_store_n(&entry->ready, success ? TB_MAPPED : TB_UNMAPPED,
+                     __ATOMIC_RELEASE);
+    return success;
+  }
+
+  // mapping only parses the header of the file, so the wait is short
+  while ((state = __atomic_load_n(&entry->ready, __ATOMIC_ACQUIRE)) == TB_MAPPING)
+#ifndef _WIN32
+    sched_yield();
+#else
+    SwitchToThread();
+#endif
+
+  return state == TB_MAPPED;
+}
+
+// Map a WDL table ahead of its first probe, fault all of its pages in from
+// disk, and optionally lock them in memory. Returns the resident size.
+static uint64 preload_wdl_entry(struct TBEntry *entry, char *str, int lock)
+{
+  if (!init_table_wdl_once(entry, str))
+    return 0;
+
+#ifndef _WIN32
+  uint64 size = entry->mapping, resident = 0;
+  long page = sysconf(_SC_PAGESIZE);
+  volatile char sum = 0;
+  uint64 i;
+
+  // ask for readahead of the whole file, then touch every page so
+  // that the faults are taken now rather than in the middle of a search
+  madvise(entry->data, size, MADV_WILLNEED);
+  for (i = 0; i < size; i += page)
+    sum += entry->data[i];
+  (void)sum;
+
+  if (lock) {
+    if (mlock(entry->data, size))
+      printf("info string could not mlock %s" WDLSUFFIX "\n", str);
+  } else
+    munlock(entry->data, size);
+
+  // count the pages which are now in memory
+  size_t pages = (size + page - 1) / page;
+  unsigned char *vec = (unsigned char *)malloc(pages);
+  if (vec && !mincore(entry->data, size, vec))
+    for (i = 0; i < pages; i++)
+      resident += (vec[i] & 1) ? (uint64)page : 0;
+  free(vec);
+  return resident > size ? size : resident;
+#else
+  (void)lock;
+  return 0;
+#endif
+}
+
+// Preload every WDL table with at most `cardinality' pieces, releasing any
+// locks held on larger tables from an earlier call
+void preload_tablebases(int cardinality, int lock)
+{
+  struct TBEntry *entry;
+  char *name;
+  uint64 resident, total = 0;
+  int i, count = 0;
+
+  for (i = 0; i < TBnum_piece + TBnum_pawn; i++) {
+    if (i < TBnum_piece) {
+      entry = (struct TBEntry *)&TB_piece[i];
+      name = TB_piece_name[i];
+    } else {
+      entry = (struct TBEntry *)&TB_pawn[i - TBnum_piece];
+      name = TB_pawn_name[i - TBnum_piece];
+    }
+
+    if (entry->num > cardinality) {
+#ifndef _WIN32
+      if (entry->ready == TB_MAPPED)
+        munlock(entry->data, entry->mapping);
+#endif
+      continue;
+    }
+
+    resident = preload_wdl_entry(entry, name, lock);
+    if (entry->ready != TB_MAPPED)
+      continue;
+
+#ifndef _WIN32
+    printf("info string preloaded %s%s resident %.1fMB of %.1fMB\n",
+           name, WDLSUFFIX, resident / 1048576.0, entry->mapping / 1048576.0);
+#else
+    printf("info string preloaded %s%s\n", name, WDLSUFFIX);
+#endif
+    total += resident;
+    count++;
+  }
+
+  printf("info string preloaded %d tablebases, %.1fMB resident%s\n",
+         count, total / 1048576.0, lock && count ? " and locked" : "");
+  fflush(stdout);
+}
+
 static void free_dtz_entry(struct TBEntry *entry)
 {
   unmap_file(entry->data, entry->mapping);
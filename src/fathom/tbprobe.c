@@ -245,10 +245,12 @@ static int probe_wdl_table(const struct pos *pos, int *success)
     if (key == KEY_KvK)
         return 0;
 
+    // Keys of tables which failed to map are cleared without the mutex,
+    // so the bucket is read and written with atomic accesses
     ptr2 = TB_hash[key >> (64 - TBHASHBITS)];
     for (i = 0; i < HSHMAX; i++)
     {
-        if (ptr2[i].key == key)
+        if (__atomic_load_n(&ptr2[i].key, __ATOMIC_RELAXED) == key)
             break;
     }
     if (i == HSHMAX)
@@ -258,31 +260,16 @@ static int probe_wdl_table(const struct pos *pos, int *success)
     }
 
     ptr = ptr2[i].ptr;
-    if (!ptr->ready)
+    if (__atomic_load_n(&ptr->ready, __ATOMIC_ACQUIRE) != TB_MAPPED)
     {
-        LOCK(TB_MUTEX);
-        if (!ptr->ready)
+        char str[16];
+        prt_str(pos, str, ptr->key != key);
+        if (!init_table_wdl_once(ptr, str))
         {
-            char str[16];
-            prt_str(pos, str, ptr->key != key);
-            if (!init_table_wdl(ptr, str))
-            {
-                ptr2[i].key = 0ULL;
-                *success = 0;
-                UNLOCK(TB_MUTEX);
-                return 0;
-            }
-            // Memory barrier to ensure ptr->ready = 1 is not reordered.
-#if !defined(__cplusplus) || !defined(TB_USE_ATOMIC)
-#ifdef __GNUC__
-            __asm__ __volatile__ ("" ::: "memory");
-#elif defined(_MSC_VER)
-            MemoryBarrier();
-#endif
-#endif
-            ptr->ready = 1;
+            __atomic_store_n(&ptr2[i].key, 0ULL, __ATOMIC_RELAXED);
+            *success = 0;
+            return 0;
         }
-        UNLOCK(TB_MUTEX);
     }
 
     int bside, mirror, cmirror;
@@ -384,7 +371,7 @@ static int probe_dtz_table(const struct pos *pos, int wdl, int *success)
             struct TBHashEntry *ptr2 = TB_hash[key >> (64 - TBHASHBITS)];
             for (i = 0; i < HSHMAX; i++)
             {
-                if (ptr2[i].key == key)
+                if (__atomic_load_n(&ptr2[i].key, __ATOMIC_RELAXED) == key)
                     break;
             }
             if (i == HSHMAX)
@@ -1378,7 +1365,7 @@ static uint16_t probe_root(const struct pos *pos, int *score,
     }
 }
 
-bool tb_init_impl(const char *path)
+bool tb_init_index_impl(const char *path, const char *index)
 {
     if (sizeof(uint64_t) != 8 ||        // Paranoid check
             sizeof(uint32_t) != 4 ||
@@ -1387,10 +1374,20 @@ bool tb_init_impl(const char *path)
         return false;
     if (path == NULL)
         path = "";
-    init_tablebases(path);
+    init_tablebases(path, index);
     return true;
 }
 
+bool tb_init_impl(const char *path)
+{
+    return tb_init_index_impl(path, NULL);
+}
+
+void tb_preload_impl(unsigned cardinality, bool lock)
+{
+    preload_tablebases((int)cardinality, lock);
+}
+
 unsigned tb_probe_wdl_impl(
     uint64_t white,
     uint64_t black,
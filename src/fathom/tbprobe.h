@@ -58,6 +58,8 @@ typedef uint8_t bool;
  * Internal definitions.  Do not call these functions directly.
  */
 extern bool tb_init_impl(const char *_path);
+extern bool tb_init_index_impl(const char *_path, const char *_index);
+extern void tb_preload_impl(unsigned _cardinality, bool _lock);
 extern unsigned tb_probe_wdl_impl(
     uint64_t _white,
     uint64_t _black,
@@ -177,6 +179,44 @@ static inline bool tb_init(const char *_path)
     return tb_init_impl(_path);
 }
 
+/*
+ * Initialize the tablebase, using an index of the tables found.
+ *
+ * PARAMETERS:
+ * - path:
+ *   The tablebase PATH string.
+ * - index:
+ *   File listing the tables found, and their sizes.  It is trusted while
+ *   the PATH string and the modification time of each directory are the
+ *   same as when it was written.  Otherwise the directories are searched,
+ *   and the index is rewritten.  NULL or empty to always search.
+ *
+ * RETURN:
+ * - As for tb_init().
+ */
+static inline bool tb_init_index(const char *_path, const char *_index)
+{
+    return tb_init_index_impl(_path, _index);
+}
+
+/*
+ * Preload the WDL tables, so that their first probes do not stall on disk.
+ *
+ * PARAMETERS:
+ * - cardinality:
+ *   Tables with at most this many pieces are mapped, and all of their pages
+ *   are read into memory.  Locks held on larger tables are released.
+ * - lock:
+ *   true=also mlock() the preloaded tables, so they are never paged out.
+ *
+ * NOTES:
+ * - The resident size of each table is reported as an "info string".
+ */
+static inline void tb_preload(unsigned _cardinality, bool _lock)
+{
+    tb_preload_impl(_cardinality, _lock);
+}
+
 /*
  * Probe the Win-Draw-Loss (WDL) table.
  *
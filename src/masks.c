@@ -18,6 +18,7 @@
 
 #include <assert.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "attacks.h"
@@ -25,9 +26,16 @@
 #include "masks.h"
 #include "types.h"
 
+#if defined(USE_TABLES)
+
+#include "tables/masks.h" // Generated ahead of time by ./Ethereal tablegen
+
+#else
+
 int DistanceBetween[SQUARE_NB][SQUARE_NB];
 int KingPawnFileDistance[FILE_NB][1 << FILE_NB];
 uint64_t BitsBetweenMasks[SQUARE_NB][SQUARE_NB];
+uint64_t LineThroughMasks[SQUARE_NB][SQUARE_NB];
 uint64_t KingAreaMasks[COLOUR_NB][SQUARE_NB];
 uint64_t ForwardRanksMasks[COLOUR_NB][RANK_NB];
 uint64_t ForwardFileMasks[COLOUR_NB][SQUARE_NB];
@@ -37,8 +45,12 @@ uint64_t PawnConnectedMasks[COLOUR_NB][SQUARE_NB];
 uint64_t OutpostSquareMasks[COLOUR_NB][SQUARE_NB];
 uint64_t OutpostRanksMasks[COLOUR_NB];
 
+#endif
+
 void initMasks() {
 
+#if !defined(USE_TABLES) // Otherwise every table was generated ahead of time
+
     // Init a table for the distance between two given squares
     for (int sq1 = 0; sq1 < SQUARE_NB; sq1++)
         for (int sq2 = 0; sq2 < SQUARE_NB; sq2++)
@@ -68,16 +80,22 @@ void initMasks() {
     // Init a table of bitmasks for the squares between two given ones (aligned on diagonal)
     for (int sq1 = 0; sq1 < SQUARE_NB; sq1++)
         for (int sq2 = 0; sq2 < SQUARE_NB; sq2++)
-            if (testBit(bishopAttacks(sq1, 0ull), sq2))
+            if (testBit(bishopAttacks(sq1, 0ull), sq2)) {
                 BitsBetweenMasks[sq1][sq2] = bishopAttacks(sq1, 1ull << sq2)
                                            & bishopAttacks(sq2, 1ull << sq1);
+                LineThroughMasks[sq1][sq2] = (bishopAttacks(sq1, 0ull) & bishopAttacks(sq2, 0ull))
+                                           | (1ull << sq1) | (1ull << sq2);
+            }
 
     // Init a table of bitmasks for the squares between two given ones (aligned on a straight)
     for (int sq1 = 0; sq1 < SQUARE_NB; sq1++)
         for (int sq2 = 0; sq2 < SQUARE_NB; sq2++)
-            if (testBit(rookAttacks(sq1, 0ull), sq2))
+            if (testBit(rookAttacks(sq1, 0ull), sq2)) {
                 BitsBetweenMasks[sq1][sq2] = rookAttacks(sq1, 1ull << sq2)
                                            & rookAttacks(sq2, 1ull << sq1);
+                LineThroughMasks[sq1][sq2] = (rookAttacks(sq1, 0ull) & rookAttacks(sq2, 0ull))
+                                           | (1ull << sq1) | (1ull << sq2);
+            }
 
     // Init a table for the King Areas. Use the King's square, the King's target
     // squares, and the squares within the pawn shield. When on the A/H files, extend
@@ -135,6 +153,25 @@ void initMasks() {
         PawnConnectedMasks[WHITE][sq] = pawnAttacks(BLACK, sq) | pawnAttacks(BLACK, sq + 8);
         PawnConnectedMasks[BLACK][sq] = pawnAttacks(WHITE, sq) | pawnAttacks(WHITE, sq - 8);
     }
+
+#endif
+}
+
+void printMaskTables(FILE *fout) {
+
+    // Every table of masks.c, in the order they are declared
+    printTable(fout, "const int DistanceBetween[SQUARE_NB][SQUARE_NB]", DistanceBetween, 4, SQUARE_NB * SQUARE_NB);
+    printTable(fout, "const int KingPawnFileDistance[FILE_NB][1 << FILE_NB]", KingPawnFileDistance, 4, FILE_NB << FILE_NB);
+    printTable(fout, "const uint64_t BitsBetweenMasks[SQUARE_NB][SQUARE_NB]", BitsBetweenMasks, 8, SQUARE_NB * SQUARE_NB);
+    printTable(fout, "const uint64_t LineThroughMasks[SQUARE_NB][SQUARE_NB]", LineThroughMasks, 8, SQUARE_NB * SQUARE_NB);
+    printTable(fout, "const uint64_t KingAreaMasks[COLOUR_NB][SQUARE_NB]", KingAreaMasks, 8, COLOUR_NB * SQUARE_NB);
+    printTable(fout, "const uint64_t ForwardRanksMasks[COLOUR_NB][RANK_NB]", ForwardRanksMasks, 8, COLOUR_NB * RANK_NB);
+    printTable(fout, "const uint64_t ForwardFileMasks[COLOUR_NB][SQUARE_NB]", ForwardFileMasks, 8, COLOUR_NB * SQUARE_NB);
+    printTable(fout, "const uint64_t AdjacentFilesMasks[FILE_NB]", AdjacentFilesMasks, 8, FILE_NB);
+    printTable(fout, "const uint64_t PassedPawnMasks[COLOUR_NB][SQUARE_NB]", PassedPawnMasks, 8, COLOUR_NB * SQUARE_NB);
+    printTable(fout, "const uint64_t PawnConnectedMasks[COLOUR_NB][SQUARE_NB]", PawnConnectedMasks, 8, COLOUR_NB * SQUARE_NB);
+    printTable(fout, "const uint64_t OutpostSquareMasks[COLOUR_NB][SQUARE_NB]", OutpostSquareMasks, 8, COLOUR_NB * SQUARE_NB);
+    printTable(fout, "const uint64_t OutpostRanksMasks[COLOUR_NB]", OutpostRanksMasks, 8, COLOUR_NB);
 }
 
 int distanceBetween(int s1, int s2) {
@@ -161,6 +198,12 @@ uint64_t bitsBetweenMasks(int s1, int s2) {
     return BitsBetweenMasks[s1][s2];
 }
 
+uint64_t lineThroughMasks(int s1, int s2) {
+    assert(0 <= s1 && s1 < SQUARE_NB);
+    assert(0 <= s2 && s2 < SQUARE_NB);
+    return LineThroughMasks[s1][s2];
+}
+
 uint64_t kingAreaMasks(int colour, int sq) {
     assert(0 <= colour && colour < COLOUR_NB);
     assert(0 <= sq && sq < SQUARE_NB);
@@ -19,15 +19,18 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdio.h>
 
 #include "types.h"
 
 void initMasks();
+void printMaskTables(FILE *fout);
 
 int distanceBetween(int sq1, int sq2);
 int kingPawnFileDistance(uint64_t pawns, int ksq);
 int openFileCount(uint64_t pawns);
 uint64_t bitsBetweenMasks(int sq1, int sq2);
+uint64_t lineThroughMasks(int sq1, int sq2);
 uint64_t kingAreaMasks(int colour, int sq);
 uint64_t forwardRanksMasks(int colour, int rank);
 uint64_t forwardFileMasks(int colour, int sq);
@@ -28,6 +28,7 @@
 #include "masks.h"
 #include "move.h"
 #include "movegen.h"
+#include "nnue.h"
 #include "search.h"
 #include "thread.h"
 #include "types.h"
@@ -40,6 +41,26 @@ static void updateCastleZobrist(Board *board, uint64_t oldRooks, uint64_t newRoo
         board->hash ^= ZobristCastleKeys[poplsb(&diff)];
 }
 
+#ifdef USE_ATTACK_MAPS
+
+static uint64_t squaresTouchedByMove(uint16_t move, int colour) {
+
+    // Every square whose contents differ before and after the move
+    const int from = MoveFrom(move), to = MoveTo(move);
+
+    if (MoveType(move) == CASTLE_MOVE)
+        return (1ull << from) | (1ull << to)
+             | (1ull << castleKingTo(from, to))
+             | (1ull << castleRookTo(from, to));
+
+    if (MoveType(move) == ENPASS_MOVE)
+        return (1ull << from) | (1ull << to) | (1ull << (to - 8 + (colour << 4)));
+
+    return (1ull << from) | (1ull << to);
+}
+
+#endif
+
 int castleKingTo(int king, int rook) {
     return square(rankOf(king), (rook > king) ? 6 : 2);
 }
@@ -48,34 +69,20 @@ int castleRookTo(int king, int rook) {
     return square(rankOf(king), (rook > king) ? 5 : 3);
 }
 
-int apply(Thread *thread, Board *board, uint16_t move, int height) {
+void apply(Thread *thread, Board *board, uint16_t move, int height) {
 
     // NULL moves are only tried when legal
     if (move == NULL_MOVE) {
         thread->moveStack[height] = NULL_MOVE;
         applyNullMove(board, &thread->undoStack[height]);
-        return 1;
+        return;
     }
 
     // Track some move information for history lookups
     thread->moveStack[height] = move;
     thread->pieceStack[height] = pieceType(board->squares[MoveFrom(move)]);
 
-    // Apply the move and reject if illegal
-    applyMove(board, move, &thread->undoStack[height]);
-    if (!moveWasLegal(board))
-        return revertMove(board, move, &thread->undoStack[height]), 0;
-
-    return 1;
-}
-
-void applyLegal(Thread *thread, Board *board, uint16_t move, int height) {
-
-    // Track some move information for history lookups
-    thread->moveStack[height] = move;
-    thread->pieceStack[height] = pieceType(board->squares[MoveFrom(move)]);
-
-    // Assumed that this move is legal
+    // The Move Picker only ever returns legal moves
     applyMove(board, move, &thread->undoStack[height]);
     assert(moveWasLegal(board));
 }
@@ -87,10 +94,17 @@ void applyMove(Board *board, uint16_t move, Undo *undo) {
         applyEnpassMove, applyPromotionMove
     };
 
+#ifndef NDEBUG
+    // Checked against the King attackers once the move has been made
+    const int givesCheck = moveGivesCheck(board, move);
+#endif
+
     // Save information which is hard to recompute
     undo->hash            = board->hash;
     undo->pkhash          = board->pkhash;
+    undo->materialKey     = board->materialKey;
     undo->kingAttackers   = board->kingAttackers;
+    undo->pinned          = board->pinned;
     undo->castleRooks     = board->castleRooks;
     undo->epSquare        = board->epSquare;
     undo->halfMoveCounter = board->halfMoveCounter;
@@ -111,11 +125,24 @@ void applyMove(Board *board, uint16_t move, Undo *undo) {
     if (board->epSquare == undo->epSquare)
         board->epSquare = -1;
 
+    // Note the changed NNUE features, when the Board has accumulators
+    if (board->accumulator != NULL)
+        nnuePushMove(board, move, undo->capturePiece);
+
+#ifdef USE_ATTACK_MAPS
+    // Refresh the attacks from, and through, each square the move touched
+    boardUpdateAttackMaps(board, squaresTouchedByMove(move, board->turn));
+    assert(boardAttackMapsAreValid(board));
+#endif
+
     // No function updates this so we do it here
     board->turn = !board->turn;
 
-    // Need king attackers to verify move legality
+    // Need king attackers for move generation. Pinned pieces are only
+    // found once we generate moves, as many nodes never get that far
     board->kingAttackers = attackersToKingSquare(board);
+    board->pinned = UNKNOWN_BITBOARD;
+    assert(givesCheck == (board->kingAttackers != 0ull));
 }
 
 void applyNormalMove(Board *board, uint16_t move, Undo *undo) {
@@ -165,6 +192,8 @@ void applyNormalMove(Board *board, uint16_t move, Undo *undo) {
     if (toType == PAWN)
         board->pkhash ^= ZobristKeys[toPiece][to];
 
+    board->materialKey -= MaterialKeys[toPiece][to];
+
     if (fromType == PAWN && (to ^ from) == 16) {
 
         uint64_t enemyPawns =  board->pieces[PAWN]
@@ -260,6 +289,8 @@ void applyEnpassMove(Board *board, uint16_t move, Undo *undo) {
                    ^  ZobristKeys[fromPiece][to]
                    ^  ZobristKeys[enpassPiece][ep];
 
+    board->materialKey -= MaterialKeys[enpassPiece][ep];
+
     assert(pieceType(fromPiece) == PAWN);
     assert(pieceType(enpassPiece) == PAWN);
 }
@@ -304,6 +335,10 @@ void applyPromotionMove(Board *board, uint16_t move, Undo *undo) {
 
     board->pkhash  ^= ZobristKeys[fromPiece][from];
 
+    board->materialKey += MaterialKeys[promoPiece][to]
+                       -  MaterialKeys[fromPiece][from]
+                       -  MaterialKeys[toPiece][to];
+
     assert(pieceType(fromPiece) == PAWN);
     assert(pieceType(toPiece) != PAWN);
     assert(pieceType(toPiece) != KING);
@@ -314,11 +349,13 @@ void applyNullMove(Board *board, Undo *undo) {
     // Save information which is hard to recompute
     // Some information is certain to stay the same
     undo->hash            = board->hash;
+    undo->pinned          = board->pinned;
     undo->epSquare        = board->epSquare;
     undo->halfMoveCounter = board->halfMoveCounter++;
 
     // NULL moves simply swap the turn only
     board->turn = !board->turn;
+    board->pinned = UNKNOWN_BITBOARD;
     board->history[board->numMoves++] = board->hash;
     board->fullMoveCounter++;
 
@@ -343,7 +380,9 @@ void revertMove(Board *board, uint16_t move, Undo *undo) {
     // Revert information which is hard to recompute
     board->hash            = undo->hash;
     board->pkhash          = undo->pkhash;
+    board->materialKey     = undo->materialKey;
     board->kingAttackers   = undo->kingAttackers;
+    board->pinned          = undo->pinned;
     board->castleRooks     = undo->castleRooks;
     board->epSquare        = undo->epSquare;
     board->halfMoveCounter = undo->halfMoveCounter;
@@ -354,6 +393,10 @@ void revertMove(Board *board, uint16_t move, Undo *undo) {
     board->numMoves--;
     board->fullMoveCounter--;
 
+    // The previous NNUE accumulator is still intact
+    if (board->accumulator != NULL)
+        board->accumulator--;
+
     if (MoveType(move) == NORMAL_MOVE) {
 
         const int fromType = pieceType(board->squares[to]);
@@ -422,6 +465,12 @@ void revertMove(Board *board, uint16_t move, Undo *undo) {
         board->squares[to] = EMPTY;
         board->squares[ep] = undo->capturePiece;
     }
+
+#ifdef USE_ATTACK_MAPS
+    // Touching the same squares again restores the previous attack maps
+    boardUpdateAttackMaps(board, squaresTouchedByMove(move, board->turn));
+    assert(boardAttackMapsAreValid(board));
+#endif
 }
 
 void revertNullMove(Board *board, Undo *undo) {
@@ -430,6 +479,7 @@ void revertNullMove(Board *board, Undo *undo) {
     // We may, and have to, zero out the king attacks
     board->hash            = undo->hash;
     board->kingAttackers   = 0ull;
+    board->pinned          = undo->pinned;
     board->epSquare        = undo->epSquare;
     board->halfMoveCounter = undo->halfMoveCounter;
 
@@ -651,6 +701,110 @@ int moveIsPseudoLegal(Board *board, uint16_t move) {
     return 0;
 }
 
+int moveIsLegal(Board *board, uint16_t move) {
+
+    int from, to, type, king, captured, kingTo, rookTo;
+    uint64_t them, occupied;
+
+    // Anything we are unable to generate is certainly illegal
+    if (!moveIsPseudoLegal(board, move))
+        return 0;
+
+    from = MoveFrom(move), to = MoveTo(move), type = MoveType(move);
+    king = getlsb(board->colours[board->turn] & board->pieces[KING]);
+    them = board->colours[!board->turn];
+    occupied = board->colours[WHITE] | board->colours[BLACK];
+
+    // King moves are legal if the new square is safe. We lift the King off the
+    // board, so that it may not hide from a slider along the line of attack
+    if (from == king && type == NORMAL_MOVE)
+        return !squareIsAttackedOccupied(board, occupied ^ (1ull << king), board->turn, to);
+
+    // Castles have already been verified up until the King's destination. With
+    // Chess960 castles, the Rook may have been shielding it from a slider
+    if (type == CASTLE_MOVE) {
+        kingTo = castleKingTo(from, to), rookTo = castleRookTo(from, to);
+        occupied = (occupied ^ (1ull << from) ^ (1ull << to)) | (1ull << kingTo) | (1ull << rookTo);
+        return !squareIsAttackedOccupied(board, occupied, board->turn, kingTo);
+    }
+
+    // Enpass removes two pieces from the same rank and may even resolve
+    // a check, so we simply verify the King's safety after the capture
+    if (type == ENPASS_MOVE) {
+        captured = to - 8 + (board->turn << 4);
+        occupied = (occupied ^ (1ull << from) ^ (1ull << captured)) | (1ull << to);
+        return !(allAttackersToSquare(board, occupied, king) & them & ~(1ull << captured));
+    }
+
+    // Double checks can only be evaded by moving the King
+    if (several(board->kingAttackers))
+        return 0;
+
+    // When checked, we may only uncheck by capturing or blocking the checker
+    if (    board->kingAttackers
+        && !testBit(board->kingAttackers | bitsBetweenMasks(king, getlsb(board->kingAttackers)), to))
+        return 0;
+
+    // Pinned pieces may only move along the line of the pin
+    return !testBit(boardPinnedPieces(board), from) || testBit(lineThroughMasks(king, from), to);
+}
+
+int moveGivesCheck(Board *board, uint16_t move) {
+
+    int from, to, type, king, rookTo, captured;
+    uint64_t occupied, bishops, rooks;
+    CheckInfo info, *ci = &info;
+
+    boardCheckInfo(board, ci);
+
+    from = MoveFrom(move), to = MoveTo(move), type = MoveType(move);
+    king = getlsb(board->colours[!board->turn] & board->pieces[KING]);
+    occupied = board->colours[WHITE] | board->colours[BLACK];
+
+    // Normal moves check if the piece lands on a checking square, or if the
+    // piece was a discoverer and has now stepped off of the line to the King
+    if (type == NORMAL_MOVE)
+        return (   pieceType(board->squares[from]) != KING
+                && testBit(ci->squares[pieceType(board->squares[from])], to))
+            || (   testBit(ci->discoverers, from)
+                && !testBit(lineThroughMasks(king, from), to));
+
+    // Discovered checks work the same for promotions. The promoted piece can
+    // not use the checking squares, as the Pawn may have been blocking itself
+    if (type == PROMOTION_MOVE) {
+        occupied = (occupied ^ (1ull << from)) | (1ull << to);
+        return (   testBit(ci->discoverers, from)
+                && !testBit(lineThroughMasks(king, from), to))
+            || (   MovePromoPiece(move) == KNIGHT && testBit(ci->squares[KNIGHT], to))
+            || (   MovePromoPiece(move) == BISHOP && testBit(bishopAttacks(to, occupied), king))
+            || (   MovePromoPiece(move) == ROOK   && testBit(rookAttacks(to, occupied), king))
+            || (   MovePromoPiece(move) == QUEEN  && testBit(queenAttacks(to, occupied), king));
+    }
+
+    bishops = board->colours[board->turn] & (board->pieces[BISHOP] | board->pieces[QUEEN]);
+    rooks   = board->colours[board->turn] & (board->pieces[ROOK  ] | board->pieces[QUEEN]);
+
+    // Enpass moves remove two pieces from the board, so we simply look for
+    // checks from the Pawn, or from any slider through the new occupancy
+    if (type == ENPASS_MOVE) {
+        captured = to - 8 + (board->turn << 4);
+        occupied = (occupied ^ (1ull << from) ^ (1ull << captured)) | (1ull << to);
+        return testBit(ci->squares[PAWN], to)
+            || (bishopAttacks(king, occupied) & bishops)
+            || (rookAttacks(king, occupied) & rooks);
+    }
+
+    // Castle moves are rare enough that we simply move both the King and the
+    // Rook, and then look for any slider which can now see the enemy King
+    assert(type == CASTLE_MOVE);
+    rookTo = castleRookTo(from, to);
+    rooks = (rooks ^ (1ull << to)) | (1ull << rookTo);
+    occupied = (occupied ^ (1ull << from) ^ (1ull << to))
+             | (1ull << castleKingTo(from, to)) | (1ull << rookTo);
+    return (bishopAttacks(king, occupied) & bishops)
+        || (rookAttacks(king, occupied) & rooks);
+}
+
 void moveToString(uint16_t move, char *str, int chess960) {
 
     int from = MoveFrom(move), to = MoveTo(move);
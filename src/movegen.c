@@ -30,28 +30,52 @@
 typedef uint64_t (*JumperFunc)(int);
 typedef uint64_t (*SliderFunc)(int, uint64_t);
 
-uint16_t * buildEnpassMoves(uint16_t *moves, uint64_t attacks, int epsq) {
+uint16_t * buildEnpassMoves(Board *board, uint16_t *moves, uint64_t attacks, int epsq) {
 
-    while (attacks)
-        *(moves++) = MoveMake(poplsb(&attacks), epsq, ENPASS_MOVE);
+    const int king = getlsb(board->colours[board->turn] & board->pieces[KING]);
+    const int captured = epsq - 8 + (board->turn << 4);
+
+    uint64_t them     = board->colours[!board->turn];
+    uint64_t occupied = board->colours[WHITE] | board->colours[BLACK];
+
+    while (attacks) {
+
+        // Enpass removes two pieces from the same rank and may even resolve
+        // a check, so we simply verify the King's safety after the capture
+        int sq = poplsb(&attacks);
+        uint64_t after = (occupied ^ (1ull << sq) ^ (1ull << captured)) | (1ull << epsq);
+
+        if (!(allAttackersToSquare(board, after, king) & them & ~(1ull << captured)))
+            *(moves++) = MoveMake(sq, epsq, ENPASS_MOVE);
+    }
 
     return moves;
 }
 
-uint16_t * buildPawnMoves(uint16_t *moves, uint64_t attacks, int delta) {
+uint16_t * buildPawnMoves(uint16_t *moves, uint64_t attacks, int delta, uint64_t pinned, int king) {
 
     while (attacks) {
         int sq = poplsb(&attacks);
+
+        // Pinned Pawns may only move along the line of the pin
+        if (testBit(pinned, sq + delta) && !testBit(lineThroughMasks(king, sq + delta), sq))
+            continue;
+
         *(moves++) = MoveMake(sq + delta, sq, NORMAL_MOVE);
     }
 
     return moves;
 }
 
-uint16_t * buildPawnPromotions(uint16_t *moves, uint64_t attacks, int delta) {
+uint16_t * buildPawnPromotions(uint16_t *moves, uint64_t attacks, int delta, uint64_t pinned, int king) {
 
     while (attacks) {
         int sq = poplsb(&attacks);
+
+        // Pinned Pawns may only move along the line of the pin
+        if (testBit(pinned, sq + delta) && !testBit(lineThroughMasks(king, sq + delta), sq))
+            continue;
+
         *(moves++) = MoveMake(sq + delta, sq,  QUEEN_PROMO_MOVE);
         *(moves++) = MoveMake(sq + delta, sq,   ROOK_PROMO_MOVE);
         *(moves++) = MoveMake(sq + delta, sq, BISHOP_PROMO_MOVE);
@@ -79,57 +103,68 @@ uint16_t * buildJumperMoves(JumperFunc F, uint16_t *moves, uint64_t pieces, uint
     return moves;
 }
 
-uint16_t * buildSliderMoves(SliderFunc F, uint16_t *moves, uint64_t pieces, uint64_t targets, uint64_t occupied) {
+uint16_t * buildSliderMoves(SliderFunc F, uint16_t *moves, uint64_t pieces, uint64_t targets, uint64_t occupied, uint64_t pinned, int king) {
 
     while (pieces) {
         int sq = poplsb(&pieces);
-        moves = buildNormalMoves(moves, F(sq, occupied) & targets, sq);
+        uint64_t attacks = F(sq, occupied) & targets;
+
+        // Pinned pieces may only slide along the line of the pin
+        if (testBit(pinned, sq))
+            attacks &= lineThroughMasks(king, sq);
+
+        moves = buildNormalMoves(moves, attacks, sq);
     }
 
     return moves;
 }
 
+uint16_t * buildKingMoves(Board *board, uint16_t *moves, int king, uint64_t targets) {
 
-int genAllLegalMoves(Board *board, uint16_t *moves) {
+    // Lift the King off the board, so that it may not hide from a slider
+    // by stepping backwards along the very line on which it was attacked
+    uint64_t occupied = (board->colours[WHITE] | board->colours[BLACK]) ^ (1ull << king);
+    uint64_t attacks  = kingAttacks(king) & targets;
 
-    Undo undo[1];
-    int size = 0, pseudo = 0;
-    uint16_t pseudoMoves[MAX_MOVES];
+    while (attacks) {
+        int sq = poplsb(&attacks);
+        if (!squareIsAttackedOccupied(board, occupied, board->turn, sq))
+            *(moves++) = MoveMake(king, sq, NORMAL_MOVE);
+    }
 
-    // Call genAllNoisyMoves() & genAllNoisyMoves()
-    pseudo  = genAllNoisyMoves(board, pseudoMoves);
-    pseudo += genAllQuietMoves(board, pseudoMoves + pseudo);
+    return moves;
+}
 
-    // Check each move for legality before copying
-    for (int i = 0; i < pseudo; i++) {
-        applyMove(board, pseudoMoves[i], undo);
-        if (moveWasLegal(board)) moves[size++] = pseudoMoves[i];
-        revertMove(board, pseudoMoves[i], undo);
-    }
 
-    return size;
+int genAllLegalMoves(Board *board, uint16_t *moves) {
+
+    // Both generators only produce legal moves
+    int size = genAllNoisyMoves(board, moves);
+    return size + genAllQuietMoves(board, moves + size);
 }
 
-int genAllNoisyMoves(Board *board, uint16_t *moves) {
+static inline int genAllNoisyMovesColour(Board *board, uint16_t *moves, const int US) {
 
     const uint16_t *start = moves;
 
-    const int Left    = board->turn == WHITE ? -7 : 7;
-    const int Right   = board->turn == WHITE ? -9 : 9;
-    const int Forward = board->turn == WHITE ? -8 : 8;
+    const int Left    = US == WHITE ? -7 : 7;
+    const int Right   = US == WHITE ? -9 : 9;
+    const int Forward = US == WHITE ? -8 : 8;
 
-    uint64_t destinations, pawnEnpass, pawnLeft, pawnRight;
+    uint64_t destinations, evasions, pawnEnpass, pawnLeft, pawnRight;
     uint64_t pawnPromoForward, pawnPromoLeft, pawnPromoRight;
 
-    uint64_t us       = board->colours[board->turn];
-    uint64_t them     = board->colours[!board->turn];
+    uint64_t us       = board->colours[US];
+    uint64_t them     = board->colours[!US];
     uint64_t occupied = us | them;
+    uint64_t pinned   = boardPinnedPieces(board);
 
     uint64_t pawns   = us & (board->pieces[PAWN  ]);
     uint64_t knights = us & (board->pieces[KNIGHT]);
     uint64_t bishops = us & (board->pieces[BISHOP]);
     uint64_t rooks   = us & (board->pieces[ROOK  ]);
     uint64_t kings   = us & (board->pieces[KING  ]);
+    int king         = getlsb(kings);
 
     // Merge together duplicate piece ideas
     bishops |= us & board->pieces[QUEEN];
@@ -137,55 +172,69 @@ int genAllNoisyMoves(Board *board, uint16_t *moves) {
 
     // Double checks can only be evaded by moving the King
     if (several(board->kingAttackers))
-        return buildJumperMoves(&kingAttacks, moves, kings, them) - start;
+        return buildKingMoves(board, moves, king, them) - start;
 
-    // When checked, we may only uncheck by capturing the checker
-    destinations = board->kingAttackers ? board->kingAttackers : them;
+    // When checked, we may only uncheck by capturing or blocking the checker
+    evasions = !board->kingAttackers ? ~0ull
+             : board->kingAttackers | bitsBetweenMasks(king, getlsb(board->kingAttackers));
+    destinations = them & evasions;
 
     // Compute bitboards for each type of Pawn movement
-    pawnEnpass       = pawnEnpassCaptures(pawns, board->epSquare, board->turn);
-    pawnLeft         = pawnLeftAttacks(pawns, them, board->turn);
-    pawnRight        = pawnRightAttacks(pawns, them, board->turn);
-    pawnPromoForward = pawnAdvance(pawns, occupied, board->turn) & PROMOTION_RANKS;
+    pawnEnpass       = pawnEnpassCaptures(pawns, board->epSquare, US);
+    pawnLeft         = pawnLeftAttacks(pawns, them, US);
+    pawnRight        = pawnRightAttacks(pawns, them, US);
+    pawnPromoForward = pawnAdvance(pawns, occupied, US) & PROMOTION_RANKS;
     pawnPromoLeft    = pawnLeft & PROMOTION_RANKS; pawnLeft &= ~PROMOTION_RANKS;
     pawnPromoRight   = pawnRight & PROMOTION_RANKS; pawnRight &= ~PROMOTION_RANKS;
 
     // Generate moves for all the Pawns, so long as they are noisy
-    moves = buildEnpassMoves(moves, pawnEnpass, board->epSquare);
-    moves = buildPawnMoves(moves, pawnLeft & destinations, Left);
-    moves = buildPawnMoves(moves, pawnRight & destinations, Right);
-    moves = buildPawnPromotions(moves, pawnPromoForward, Forward);
-    moves = buildPawnPromotions(moves, pawnPromoLeft, Left);
-    moves = buildPawnPromotions(moves, pawnPromoRight, Right);
-
-    // Generate moves for the remainder of the pieces, so long as they are noisy
-    moves = buildJumperMoves(&knightAttacks, moves, knights, destinations);
-    moves = buildSliderMoves(&bishopAttacks, moves, bishops, destinations, occupied);
-    moves = buildSliderMoves(&rookAttacks, moves, rooks, destinations, occupied);
-    moves = buildJumperMoves(&kingAttacks, moves, kings, them);
+    moves = buildEnpassMoves(board, moves, pawnEnpass, board->epSquare);
+    moves = buildPawnMoves(moves, pawnLeft & destinations, Left, pinned, king);
+    moves = buildPawnMoves(moves, pawnRight & destinations, Right, pinned, king);
+    moves = buildPawnPromotions(moves, pawnPromoForward & evasions, Forward, pinned, king);
+    moves = buildPawnPromotions(moves, pawnPromoLeft & destinations, Left, pinned, king);
+    moves = buildPawnPromotions(moves, pawnPromoRight & destinations, Right, pinned, king);
+
+    // Generate moves for the remainder of the pieces, so long as they are noisy.
+    // Pinned Knights are never able to move, as they can not stay on the line
+    moves = buildJumperMoves(&knightAttacks, moves, knights & ~pinned, destinations);
+    moves = buildSliderMoves(&bishopAttacks, moves, bishops, destinations, occupied, pinned, king);
+    moves = buildSliderMoves(&rookAttacks, moves, rooks, destinations, occupied, pinned, king);
+    moves = buildKingMoves(board, moves, king, them);
 
     return moves - start;
 }
 
-int genAllQuietMoves(Board *board, uint16_t *moves) {
+int genAllNoisyMoves(Board *board, uint16_t *moves) {
+
+    // Dispatch once per node, so that each instantiation has a constant
+    // colour, turning the Pawn shifts and rank masks into immediates
+    return board->turn == WHITE ? genAllNoisyMovesColour(board, moves, WHITE)
+                                : genAllNoisyMovesColour(board, moves, BLACK);
+}
+
+static inline int genAllQuietMovesColour(Board *board, uint16_t *moves, const int US) {
 
     const uint16_t *start = moves;
 
-    const int Forward = board->turn == WHITE ? -8 : 8;
-    const uint64_t Rank3Relative = board->turn == WHITE ? RANK_3 : RANK_6;
+    const int Forward = US == WHITE ? -8 : 8;
+    const uint64_t Rank3Relative = US == WHITE ? RANK_3 : RANK_6;
 
-    int rook, king, rookTo, kingTo, attacked;
+    int rook, rookTo, kingTo, attacked;
     uint64_t destinations, pawnForwardOne, pawnForwardTwo, mask;
 
-    uint64_t us       = board->colours[board->turn];
-    uint64_t occupied = us | board->colours[!board->turn];
+    uint64_t us       = board->colours[US];
+    uint64_t them     = board->colours[!US];
+    uint64_t occupied = us | them;
     uint64_t castles  = us & board->castleRooks;
+    uint64_t pinned   = boardPinnedPieces(board);
 
     uint64_t pawns   = us & (board->pieces[PAWN  ]);
     uint64_t knights = us & (board->pieces[KNIGHT]);
     uint64_t bishops = us & (board->pieces[BISHOP]);
     uint64_t rooks   = us & (board->pieces[ROOK  ]);
     uint64_t kings   = us & (board->pieces[KING  ]);
+    int king         = getlsb(kings);
 
     // Merge together duplicate piece ideas
     bishops |= us & board->pieces[QUEEN];
@@ -193,31 +242,32 @@ int genAllQuietMoves(Board *board, uint16_t *moves) {
 
     // Double checks can only be evaded by moving the King
     if (several(board->kingAttackers))
-        return buildJumperMoves(&kingAttacks, moves, kings, ~occupied) - start;
+        return buildKingMoves(board, moves, king, ~occupied) - start;
 
     // When checked, we must block the checker with non-King pieces
     destinations = !board->kingAttackers ? ~occupied
-                 : ~occupied & bitsBetweenMasks(getlsb(kings), getlsb(board->kingAttackers));
+                 : ~occupied & bitsBetweenMasks(king, getlsb(board->kingAttackers));
 
     // Compute bitboards for each type of Pawn movement
-    pawnForwardOne = pawnAdvance(pawns, occupied, board->turn) & ~PROMOTION_RANKS;
-    pawnForwardTwo = pawnAdvance(pawnForwardOne & Rank3Relative, occupied, board->turn);
+    pawnForwardOne = pawnAdvance(pawns, occupied, US) & ~PROMOTION_RANKS;
+    pawnForwardTwo = pawnAdvance(pawnForwardOne & Rank3Relative, occupied, US);
 
     // Generate moves for all the pawns, so long as they are quiet
-    moves = buildPawnMoves(moves, pawnForwardOne & destinations, Forward);
-    moves = buildPawnMoves(moves, pawnForwardTwo & destinations, Forward * 2);
+    moves = buildPawnMoves(moves, pawnForwardOne & destinations, Forward, pinned, king);
+    moves = buildPawnMoves(moves, pawnForwardTwo & destinations, Forward * 2, pinned, king);
 
-    // Generate moves for the remainder of the pieces, so long as they are quiet
-    moves = buildJumperMoves(&knightAttacks, moves, knights, destinations);
-    moves = buildSliderMoves(&bishopAttacks, moves, bishops, destinations, occupied);
-    moves = buildSliderMoves(&rookAttacks, moves, rooks, destinations, occupied);
-    moves = buildJumperMoves(&kingAttacks, moves, kings, ~occupied);
+    // Generate moves for the remainder of the pieces, so long as they are quiet.
+    // Pinned Knights are never able to move, as they can not stay on the line
+    moves = buildJumperMoves(&knightAttacks, moves, knights & ~pinned, destinations);
+    moves = buildSliderMoves(&bishopAttacks, moves, bishops, destinations, occupied, pinned, king);
+    moves = buildSliderMoves(&rookAttacks, moves, rooks, destinations, occupied, pinned, king);
+    moves = buildKingMoves(board, moves, king, ~occupied);
 
     // Attempt to generate a castle move for each rook
     while (castles && !board->kingAttackers) {
 
         // Figure out which pieces are moving to which squares
-        rook = poplsb(&castles), king = getlsb(kings);
+        rook = poplsb(&castles);
         rookTo = castleRookTo(king, rook);
         kingTo = castleKingTo(king, rook);
         attacked = 0;
@@ -231,13 +281,26 @@ int genAllQuietMoves(Board *board, uint16_t *moves) {
         // Castle is illegal if we move through a checking threat
         mask = bitsBetweenMasks(king, kingTo);
         while (mask)
-            if (squareIsAttacked(board, board->turn, poplsb(&mask)))
+            if (squareIsAttacked(board, US, poplsb(&mask)))
                 { attacked = 1; break; }
         if (attacked) continue;
 
+        // Castle is illegal if we would land in check. With Chess960 castles,
+        // the Rook may have been shielding the King's destination from a slider
+        mask = (occupied ^ (1ull << king) ^ (1ull << rook)) | (1ull << kingTo) | (1ull << rookTo);
+        if (squareIsAttackedOccupied(board, mask, US, kingTo)) continue;
+
         // All conditions have been met. Identify which side we are castling to
         *(moves++) = MoveMake(king, rook, CASTLE_MOVE);
     }
 
     return moves - start;
 }
+
+int genAllQuietMoves(Board *board, uint16_t *moves) {
+
+    // Dispatch once per node, so that each instantiation has a constant
+    // colour, turning the Pawn shifts and rank masks into immediates
+    return board->turn == WHITE ? genAllQuietMovesColour(board, moves, WHITE)
+                                : genAllQuietMovesColour(board, moves, BLACK);
+}
@@ -23,6 +23,7 @@
 #include "move.h"
 #include "movegen.h"
 #include "movepicker.h"
+#include "search.h"
 #include "types.h"
 #include "thread.h"
 
@@ -83,6 +84,9 @@ void initMovePicker(MovePicker *mp, Thread *thread, uint16_t ttMove, int height)
     // Lookup our refutations (killers and counter moves)
     getRefutationMoves(thread, height, &mp->killer1, &mp->killer2, &mp->counter);
 
+    // Occupancy and slider sets are shared by every SEE call at this node
+    initSEEContext(&mp->see, &thread->board);
+
     // General housekeeping
     mp->threshold = 0;
     mp->thread = thread;
@@ -106,6 +110,9 @@ void initNoisyMovePicker(MovePicker *mp, Thread *thread, int threshold) {
     // Skip all of the special (refutation and table) moves
     mp->tableMove = mp->killer1 = mp->killer2 = mp->counter = NONE_MOVE;
 
+    // Occupancy and slider sets are shared by every SEE call at this node
+    initSEEContext(&mp->see, &thread->board);
+
     // General housekeeping
     mp->threshold = threshold;
     mp->thread = thread;
@@ -121,9 +128,9 @@ uint16_t selectNextMove(MovePicker *mp, Board *board, int skipQuiets) {
 
         case STAGE_TABLE:
 
-            // Play table move if it is pseudo legal
+            // Play table move if it is legal
             mp->stage = STAGE_GENERATE_NOISY;
-            if (moveIsPseudoLegal(board, mp->tableMove))
+            if (moveIsLegal(board, mp->tableMove))
                 return mp->tableMove;
 
             /* fallthrough */
@@ -152,7 +159,7 @@ uint16_t selectNextMove(MovePicker *mp, Board *board, int skipQuiets) {
 
                     // Skip moves which fail to beat our SEE margin. We flag those moves
                     // as failed with the value (-1), and then repeat the selection process
-                    if (!staticExchangeEvaluation(board, mp->moves[best], mp->threshold)) {
+                    if (!staticExchangeEvaluation(board, &mp->see, mp->moves[best], mp->threshold)) {
                         mp->values[best] = -1;
                         return selectNextMove(mp, board, skipQuiets);
                     }
@@ -185,35 +192,35 @@ uint16_t selectNextMove(MovePicker *mp, Board *board, int skipQuiets) {
 
         case STAGE_KILLER_1:
 
-            // Play killer move if not yet played, and pseudo legal
+            // Play killer move if not yet played, and legal
             mp->stage = STAGE_KILLER_2;
             if (   !skipQuiets
                 &&  mp->killer1 != mp->tableMove
-                &&  moveIsPseudoLegal(board, mp->killer1))
+                &&  moveIsLegal(board, mp->killer1))
                 return mp->killer1;
 
             /* fallthrough */
 
         case STAGE_KILLER_2:
 
-            // Play killer move if not yet played, and pseudo legal
+            // Play killer move if not yet played, and legal
             mp->stage = STAGE_COUNTER_MOVE;
             if (   !skipQuiets
                 &&  mp->killer2 != mp->tableMove
-                &&  moveIsPseudoLegal(board, mp->killer2))
+                &&  moveIsLegal(board, mp->killer2))
                 return mp->killer2;
 
             /* fallthrough */
 
         case STAGE_COUNTER_MOVE:
 
-            // Play counter move if not yet played, and pseudo legal
+            // Play counter move if not yet played, and legal
             mp->stage = STAGE_GENERATE_QUIET;
             if (   !skipQuiets
                 &&  mp->counter != mp->tableMove
                 &&  mp->counter != mp->killer1
                 &&  mp->counter != mp->killer2
-                &&  moveIsPseudoLegal(board, mp->counter))
+                &&  moveIsLegal(board, mp->counter))
                 return mp->counter;
 
             /* fallthrough */
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "search.h"
 #include "types.h"
 
 enum { NORMAL_PICKER, NOISY_PICKER };
@@ -37,6 +38,7 @@ struct MovePicker {
     int values[MAX_MOVES];
     uint16_t moves[MAX_MOVES];
     uint16_t tableMove, killer1, killer2, counter;
+    SEEContext see;
     Thread *thread;
 };
 
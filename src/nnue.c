@@ -0,0 +1,497 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__AVX2__) || defined(__SSSE3__) || defined(__SSE2__)
+    #include <immintrin.h>
+#endif
+
+#include "bitboards.h"
+#include "board.h"
+#include "move.h"
+#include "nnue.h"
+#include "types.h"
+
+int UseNNUE = 0;            // Set by the UseNNUE UCI option
+static NNUENetwork Network; // Read-only, and shared by all Threads
+
+static const char NNUEMagic[8] = { 'E', 'T', 'H', 'N', 'N', 'U', 'E', '1' };
+
+enum { NNUE_HEADER_SIZE = 64 };
+
+/* Vectorized Kernels, with scalar fallbacks */
+
+#if defined(__AVX2__)
+
+    typedef __m256i vepi;
+    #define NNUE_VEC 32
+    #define vepiLoad(p)      _mm256_loadu_si256((const __m256i *)(p))
+    #define vepiStore(p, v)  _mm256_storeu_si256((__m256i *)(p), (v))
+    #define vepiAdd16        _mm256_add_epi16
+    #define vepiSub16        _mm256_sub_epi16
+    #define vepiZero         _mm256_setzero_si256
+
+    // Accumulate the dot products of each four uint8s and int8s into int32s,
+    // in a single instruction when the CPU supports AVX-VNNI
+
+    static vepi vepiDpbusd(vepi sum, vepi u8, vepi i8) {
+    #if defined(__AVXVNNI__)
+        return _mm256_dpbusd_avx_epi32(sum, u8, i8);
+    #else
+        const vepi products = _mm256_maddubs_epi16(u8, i8);
+        return _mm256_add_epi32(sum, _mm256_madd_epi16(products, _mm256_set1_epi16(1)));
+    #endif
+    }
+
+    static __m128i vepiSum32x4(vepi a, vepi b, vepi c, vepi d) {
+        a = _mm256_hadd_epi32(_mm256_hadd_epi32(a, b), _mm256_hadd_epi32(c, d));
+        return _mm_add_epi32(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1));
+    }
+
+#elif defined(__SSE2__)
+
+    typedef __m128i vepi;
+    #define NNUE_VEC 16
+    #define vepiLoad(p)      _mm_loadu_si128((const __m128i *)(p))
+    #define vepiStore(p, v)  _mm_storeu_si128((__m128i *)(p), (v))
+    #define vepiAdd16        _mm_add_epi16
+    #define vepiSub16        _mm_sub_epi16
+    #define vepiZero         _mm_setzero_si128
+
+    #if defined(__SSSE3__)
+
+    static vepi vepiDpbusd(vepi sum, vepi u8, vepi i8) {
+        const vepi products = _mm_maddubs_epi16(u8, i8);
+        return _mm_add_epi32(sum, _mm_madd_epi16(products, _mm_set1_epi16(1)));
+    }
+
+    static __m128i vepiSum32x4(vepi a, vepi b, vepi c, vepi d) {
+        return _mm_hadd_epi32(_mm_hadd_epi32(a, b), _mm_hadd_epi32(c, d));
+    }
+
+    #endif
+
+#endif
+
+static void nnueApplyFeatures(int16_t *out, const int16_t *in, const int *adds, int nadds, const int *subs, int nsubs) {
+
+    // Sum the columns of the added features into the accumulator, and
+    // remove those of the removed features. The int16s may wrap around
+    // in between, but the final result fits, so the wrapping cancels out
+
+#if defined(NNUE_VEC)
+
+    for (int i = 0; i < NNUE_HIDDEN; i += NNUE_VEC / 2) {
+
+        vepi acc = vepiLoad(&in[i]);
+
+        for (int j = 0; j < nadds; j++)
+            acc = vepiAdd16(acc, vepiLoad(&Network.ftWeights[adds[j] * NNUE_HIDDEN + i]));
+
+        for (int j = 0; j < nsubs; j++)
+            acc = vepiSub16(acc, vepiLoad(&Network.ftWeights[subs[j] * NNUE_HIDDEN + i]));
+
+        vepiStore(&out[i], acc);
+    }
+
+#else
+
+    memcpy(out, in, sizeof(int16_t) * NNUE_HIDDEN);
+
+    for (int j = 0; j < nadds; j++)
+        for (int i = 0; i < NNUE_HIDDEN; i++)
+            out[i] += Network.ftWeights[adds[j] * NNUE_HIDDEN + i];
+
+    for (int j = 0; j < nsubs; j++)
+        for (int i = 0; i < NNUE_HIDDEN; i++)
+            out[i] -= Network.ftWeights[subs[j] * NNUE_HIDDEN + i];
+
+#endif
+}
+
+static void nnueTransform(uint8_t *out, const int16_t *in) {
+
+    // Clip each accumulator value into [0, 127], for use as uint8 inputs
+
+#if defined(__AVX2__)
+
+    const __m256i max = _mm256_set1_epi8(127);
+
+    for (int i = 0; i < NNUE_HIDDEN; i += 32) {
+        __m256i packed = _mm256_packus_epi16(vepiLoad(&in[i]), vepiLoad(&in[i+16]));
+        packed = _mm256_min_epu8(packed, max);
+        vepiStore(&out[i], _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+
+#elif defined(__SSE2__)
+
+    const __m128i max = _mm_set1_epi8(127);
+
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m128i packed = _mm_packus_epi16(vepiLoad(&in[i]), vepiLoad(&in[i+8]));
+        vepiStore(&out[i], _mm_min_epu8(packed, max));
+    }
+
+#else
+
+    for (int i = 0; i < NNUE_HIDDEN; i++)
+        out[i] = MAX(0, MIN(127, in[i]));
+
+#endif
+}
+
+static void nnueAffine(int32_t *out, const uint8_t *in, int nin, const int8_t *weights, const int32_t *biases, int nout) {
+
+    // Compute out = biases + weights * in, for uint8 inputs and int8 weights, and a
+    // multiple of four rows. The inputs never exceed 127, so maddubs can not saturate
+
+#if defined(NNUE_VEC) && (defined(__AVX2__) || defined(__SSSE3__))
+
+    // Work on four rows at once, so that the horizontal sums can be shared
+
+    for (int i = 0; i < nout; i += 4) {
+
+        vepi sum0 = vepiZero(), sum1 = vepiZero(), sum2 = vepiZero(), sum3 = vepiZero();
+        const int8_t *row = &weights[i * nin];
+
+        for (int j = 0; j < nin; j += NNUE_VEC) {
+            const vepi input = vepiLoad(&in[j]);
+            sum0 = vepiDpbusd(sum0, input, vepiLoad(&row[0 * nin + j]));
+            sum1 = vepiDpbusd(sum1, input, vepiLoad(&row[1 * nin + j]));
+            sum2 = vepiDpbusd(sum2, input, vepiLoad(&row[2 * nin + j]));
+            sum3 = vepiDpbusd(sum3, input, vepiLoad(&row[3 * nin + j]));
+        }
+
+        __m128i sums = _mm_add_epi32(vepiSum32x4(sum0, sum1, sum2, sum3), _mm_loadu_si128((const __m128i *) &biases[i]));
+        _mm_storeu_si128((__m128i *) &out[i], sums);
+    }
+
+#else
+
+    for (int i = 0; i < nout; i++) {
+        out[i] = biases[i];
+        for (int j = 0; j < nin; j++)
+            out[i] += in[j] * weights[i * nin + j];
+    }
+
+#endif
+}
+
+static int32_t nnueOutput(const uint8_t *in, const int8_t *weights, int32_t bias) {
+
+    // The output layer is a single dot product, over NNUE_L2 inputs
+
+#if defined(NNUE_VEC) && (defined(__AVX2__) || defined(__SSSE3__))
+
+    vepi sum = vepiZero();
+
+    for (int i = 0; i < NNUE_L2; i += NNUE_VEC)
+        sum = vepiDpbusd(sum, vepiLoad(&in[i]), vepiLoad(&weights[i]));
+
+    return bias + _mm_cvtsi128_si32(vepiSum32x4(sum, sum, sum, sum));
+
+#else
+
+    for (int i = 0; i < NNUE_L2; i++)
+        bias += in[i] * weights[i];
+
+    return bias;
+
+#endif
+}
+
+static void nnueActivate(uint8_t *out, const int32_t *in, int n) {
+
+    // Scale down the hidden layer outputs, and then clip into [0, 127]
+    for (int i = 0; i < n; i++)
+        out[i] = MAX(0, MIN(127, in[i] >> NNUE_SHIFT));
+}
+
+/* Network Loading */
+
+static size_t nnueFileSize() {
+
+    return NNUE_HEADER_SIZE
+         + sizeof(int16_t) * NNUE_HIDDEN
+         + sizeof(int16_t) * NNUE_FEATURES * NNUE_HIDDEN
+         + sizeof(int32_t) * NNUE_L1 + sizeof(int8_t) * NNUE_L1 * 2 * NNUE_HIDDEN
+         + sizeof(int32_t) * NNUE_L2 + sizeof(int8_t) * NNUE_L2 * NNUE_L1
+         + sizeof(int8_t)  * NNUE_L2 + sizeof(int32_t);
+}
+
+static uint32_t nnueReadU32(const unsigned char *data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static void *nnueMapFile(const char *fname, size_t *size) {
+
+    // Windows lacks mmap(), so there we just read the file into memory
+
+#if defined(_WIN32) || defined(_WIN64)
+
+    void *data;
+    FILE *fin = fopen(fname, "rb");
+
+    if (fin == NULL) return NULL;
+
+    fseek(fin, 0, SEEK_END);
+    *size = (size_t)ftell(fin);
+    fseek(fin, 0, SEEK_SET);
+
+    if ((data = malloc(*size)) != NULL && fread(data, 1, *size, fin) != *size)
+        free(data), data = NULL;
+
+    fclose(fin);
+    return data;
+
+#else
+
+    // Map the file read-only. Every Thread shares the same pages, and
+    // the kernel only needs to read in the parts that we actually use
+
+    void *data;
+    struct stat st;
+    int fd = open(fname, O_RDONLY);
+
+    if (fd == -1) return NULL;
+
+    if (fstat(fd, &st) == -1 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+
+    *size = (size_t)st.st_size;
+    data = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    return data == MAP_FAILED ? NULL : data;
+
+#endif
+}
+
+static void nnueUnmapFile(void *data, size_t size) {
+
+#if defined(_WIN32) || defined(_WIN64)
+    (void) size; free(data);
+#else
+    munmap(data, size);
+#endif
+}
+
+int nnueInit(const char *fname) {
+
+    size_t size = 0;
+    const unsigned char *data;
+
+    // Release any previously loaded Network
+    nnueFree();
+
+    if ((data = nnueMapFile(fname, &size)) == NULL)
+        return 0;
+
+    // The header holds a magic string and then the Network's dimensions,
+    // which must match our own exactly. The size must then match as well
+    if (   size != nnueFileSize()
+        || memcmp(data, NNUEMagic, sizeof(NNUEMagic))
+        || nnueReadU32(data +  8) != NNUE_FEATURES
+        || nnueReadU32(data + 12) != NNUE_HIDDEN
+        || nnueReadU32(data + 16) != NNUE_L1
+        || nnueReadU32(data + 20) != NNUE_L2) {
+        nnueUnmapFile((void *) data, size);
+        return 0;
+    }
+
+    Network.mapping = (void *) data;
+    Network.size    = size;
+    data += NNUE_HEADER_SIZE;
+
+    // Point into the mapping for each of the layers. Every layer other than
+    // the last starts on a 64 byte boundary, but we only ever do unaligned loads
+
+    Network.ftBiases  = (const int16_t *) data; data += sizeof(int16_t) * NNUE_HIDDEN;
+    Network.ftWeights = (const int16_t *) data; data += sizeof(int16_t) * NNUE_FEATURES * NNUE_HIDDEN;
+    Network.l1Biases  = (const int32_t *) data; data += sizeof(int32_t) * NNUE_L1;
+    Network.l1Weights = (const int8_t  *) data; data += sizeof(int8_t)  * NNUE_L1 * 2 * NNUE_HIDDEN;
+    Network.l2Biases  = (const int32_t *) data; data += sizeof(int32_t) * NNUE_L2;
+    Network.l2Weights = (const int8_t  *) data; data += sizeof(int8_t)  * NNUE_L2 * NNUE_L1;
+    Network.l3Weights = (const int8_t  *) data; data += sizeof(int8_t)  * NNUE_L2;
+    Network.l3Bias    = (const int32_t *) data;
+
+    return 1;
+}
+
+void nnueFree() {
+
+    if (Network.mapping != NULL)
+        nnueUnmapFile(Network.mapping, Network.size);
+
+    memset(&Network, 0, sizeof(NNUENetwork));
+}
+
+int nnueEnabled() {
+    return UseNNUE && Network.mapping != NULL;
+}
+
+/* Accumulator Maintenance */
+
+static int nnueFeature(int colour, int king, int piece, int sq) {
+
+    // Pieces are indexed relative to the perspective, as ours or theirs,
+    // and the board is flipped vertically for Black. Kings are not inputs
+
+    const int relative = 2 * pieceType(piece) + (pieceColour(piece) != colour);
+
+    if (colour == BLACK) king ^= 56, sq ^= 56;
+
+    return 640 * king + 64 * relative + sq;
+}
+
+static void nnueRefreshColour(Board *board, NNUEAccumulator *acc, int colour) {
+
+    int features[32], count = 0;
+
+    const int king = getlsb(board->colours[colour] & board->pieces[KING]);
+    uint64_t pieces = (board->colours[WHITE] | board->colours[BLACK]) & ~board->pieces[KING];
+
+    // Build the accumulator from the biases and every non-King piece
+    while (pieces) {
+        int sq = poplsb(&pieces);
+        features[count++] = nnueFeature(colour, king, board->squares[sq], sq);
+    }
+
+    nnueApplyFeatures(acc->values[colour], Network.ftBiases, features, count, NULL, 0);
+    acc->computed[colour] = 1;
+}
+
+static void nnueUpdateColour(Board *board, int colour) {
+
+    NNUEAccumulator *acc = board->accumulator, *src = acc;
+    const int king = getlsb(board->colours[colour] & board->pieces[KING]);
+
+    // Walk back to the last accumulator computed for this colour. The root
+    // is always computed, but if our King moved along the way then every
+    // feature changed, and building the accumulator from scratch is cheaper
+    while (!src->computed[colour]) {
+        if (src->kingMoved == colour) {
+            nnueRefreshColour(board, acc, colour);
+            return;
+        }
+        src--;
+    }
+
+    // Replay the feature changes from each move, one ply at a time
+    for (src = src + 1; src <= acc; src++) {
+
+        int adds[2], subs[2];
+
+        for (int i = 0; i < src->nadded; i++)
+            adds[i] = nnueFeature(colour, king, src->added[i] >> 6, src->added[i] & 63);
+
+        for (int i = 0; i < src->nremoved; i++)
+            subs[i] = nnueFeature(colour, king, src->removed[i] >> 6, src->removed[i] & 63);
+
+        nnueApplyFeatures(src->values[colour], (src-1)->values[colour],
+                          adds, src->nadded, subs, src->nremoved);
+
+        src->computed[colour] = 1;
+    }
+}
+
+void nnueRefreshAccumulator(Board *board) {
+    nnueRefreshColour(board, board->accumulator, WHITE);
+    nnueRefreshColour(board, board->accumulator, BLACK);
+}
+
+void nnuePushMove(Board *board, uint16_t move, int capturePiece) {
+
+    // Called by applyMove() once the pieces have been moved, but before the
+    // turn is changed. We only note what changed here, and leave the work of
+    // updating the accumulators until they are needed by nnueEvaluate()
+
+    NNUEAccumulator *acc = ++board->accumulator;
+
+    const int from  = MoveFrom(move);
+    const int to    = MoveTo(move);
+    const int piece = board->squares[to];
+
+    acc->computed[WHITE] = acc->computed[BLACK] = 0;
+    acc->kingMoved = -1, acc->nadded = acc->nremoved = 0;
+
+    // Only the Rook is an input, but the King's move forces a refresh
+    if (MoveType(move) == CASTLE_MOVE) {
+        acc->kingMoved = board->turn;
+        acc->removed[acc->nremoved++] = (makePiece(ROOK, board->turn) << 6) | to;
+        acc->added[acc->nadded++]     = (makePiece(ROOK, board->turn) << 6) | castleRookTo(from, to);
+        return;
+    }
+
+    // Enpass captures are the only ones not made on the destination square
+    if (capturePiece != EMPTY) {
+        int sq = MoveType(move) == ENPASS_MOVE ? to - 8 + (board->turn << 4) : to;
+        acc->removed[acc->nremoved++] = (capturePiece << 6) | sq;
+    }
+
+    // The moving King is not an input, but forces a refresh
+    if (pieceType(piece) == KING)
+        acc->kingMoved = board->turn;
+
+    // Promotions replace a Pawn, otherwise the same piece moves
+    else {
+        int moved = MoveType(move) == PROMOTION_MOVE ? makePiece(PAWN, board->turn) : piece;
+        acc->removed[acc->nremoved++] = (moved << 6) | from;
+        acc->added[acc->nadded++]     = (piece << 6) | to;
+    }
+}
+
+/* Evaluation */
+
+int nnueEvaluate(Board *board) {
+
+    uint8_t input[2 * NNUE_HIDDEN], hidden1[NNUE_L1], hidden2[NNUE_L2];
+    int32_t layer1[NNUE_L1], layer2[NNUE_L2], output;
+
+    NNUEAccumulator *acc = board->accumulator;
+
+    // Bring both perspectives up to date, from any prior accumulators
+    nnueUpdateColour(board, WHITE);
+    nnueUpdateColour(board, BLACK);
+
+    // The side to move is always the first half of the inputs
+    nnueTransform(&input[0], acc->values[board->turn]);
+    nnueTransform(&input[NNUE_HIDDEN], acc->values[!board->turn]);
+
+    // Propagate through the two hidden layers and the output layer
+    nnueAffine(layer1, input, 2 * NNUE_HIDDEN, Network.l1Weights, Network.l1Biases, NNUE_L1);
+    nnueActivate(hidden1, layer1, NNUE_L1);
+    nnueAffine(layer2, hidden1, NNUE_L1, Network.l2Weights, Network.l2Biases, NNUE_L2);
+    nnueActivate(hidden2, layer2, NNUE_L2);
+    output = nnueOutput(hidden2, Network.l3Weights, *Network.l3Bias);
+
+    return output / NNUE_SCALE;
+}
@@ -0,0 +1,55 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "types.h"
+
+enum {
+    NNUE_FEATURES = 64 * 640, // HalfKP: King Square x (10 Pieces x 64 Squares)
+    NNUE_HIDDEN   = 256,      // Accumulator width for each of the two perspectives
+    NNUE_L1       = 32,       // Width of the first hidden layer
+    NNUE_L2       = 32,       // Width of the second hidden layer
+    NNUE_SHIFT    = 6,        // Hidden layer outputs are scaled down by 2^6
+    NNUE_SCALE    = 16,       // The final output is scaled down by 16
+};
+
+struct NNUENetwork {
+    void *mapping;
+    size_t size;
+    const int16_t *ftBiases, *ftWeights;
+    const int32_t *l1Biases, *l2Biases, *l3Bias;
+    const int8_t  *l1Weights, *l2Weights, *l3Weights;
+};
+
+struct NNUEAccumulator {
+    int16_t values[COLOUR_NB][NNUE_HIDDEN];
+    int computed[COLOUR_NB];
+    int kingMoved, nadded, nremoved;
+    int added[2], removed[2];
+};
+
+int nnueInit(const char *fname);
+void nnueFree();
+int nnueEnabled();
+void nnueRefreshAccumulator(Board *board);
+void nnuePushMove(Board *board, uint16_t move, int capturePiece);
+int nnueEvaluate(Board *board);
@@ -0,0 +1,260 @@
+/*
+  Ethereal is a UCI chess playing engine authored by Andrew Grant.
+  <https://github.com/AndyGrant/Ethereal>     <andrew@grantnet.us>
+
+  Ethereal is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Ethereal is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board.h"
+#include "move.h"
+#include "movegen.h"
+#include "perft.h"
+#include "time.h"
+#include "types.h"
+
+static const uint64_t MB = 1ull << 20;
+
+// Mixed into the position hash so that each depth has its own key
+static const uint64_t PerftDepthMultiplier = 0x9E3779B97F4A7C15ull;
+
+typedef struct PerftRootJob {
+    PerftTable *table;
+    Board *board;
+    uint16_t moves[MAX_MOVES];
+    int size, depth, next;
+    uint64_t nodes;
+} PerftRootJob;
+
+typedef struct PerftSuiteJob {
+    PerftTable *table;
+    char **lines;
+    int count, maxDepth, next;
+    int tested, fails;
+    uint64_t nodes;
+} PerftSuiteJob;
+
+static void *perftRootWorker(void *cargo) {
+
+    PerftRootJob *job = (PerftRootJob*) cargo;
+
+    Undo undo[1];
+    Board board;
+    uint64_t keyStack[KEY_STACK_SIZE], nodes = 0ull;
+
+    // Work on our own copy of the Board, with our own key stack
+    memcpy(&board, job->board, sizeof(Board));
+    board.history = keyStack;
+
+    // Take root moves one at a time until there are none remaining
+    for (int i; (i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED)) < job->size; ) {
+        applyMove(&board, job->moves[i], undo);
+        nodes += perftHashed(job->table, &board, job->depth - 1);
+        revertMove(&board, job->moves[i], undo);
+    }
+
+    __atomic_fetch_add(&job->nodes, nodes, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static int perftSuiteParse(char *line, int maxDepth, char *fen, int *depth, uint64_t *expected) {
+
+    // Lines are of the form "<fen> ;D1 <nodes> ;D2 <nodes> ...". We keep
+    // the deepest depth which is no larger than the maximum requested
+    int d; uint64_t nodes; char *ptr = strchr(line, ';');
+
+    if (ptr == NULL) return 0;
+
+    memcpy(fen, line, ptr - line);
+    fen[ptr - line] = '\0';
+
+    for (*depth = 0; ptr != NULL; ptr = strchr(ptr + 1, ';'))
+        if (sscanf(ptr, ";D%d %"SCNu64, &d, &nodes) == 2 && d <= maxDepth && d > *depth)
+            *depth = d, *expected = nodes;
+
+    return *depth > 0;
+}
+
+static void *perftSuiteWorker(void *cargo) {
+
+    PerftSuiteJob *job = (PerftSuiteJob*) cargo;
+
+    Board board;
+    char fen[256];
+    int depth, tested = 0, fails = 0;
+    uint64_t keyStack[KEY_STACK_SIZE], expected, found, nodes = 0ull;
+
+    board.history = keyStack;
+
+    // Take positions one at a time, sharing only the hash table
+    for (int i; (i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED)) < job->count; ) {
+
+        if (!perftSuiteParse(job->lines[i], job->maxDepth, fen, &depth, &expected))
+            continue;
+
+        boardFromFEN(&board, fen, 0);
+        found = perftHashed(job->table, &board, depth);
+        tested++, nodes += found;
+
+        if (found != expected) {
+            printf("FAIL %s depth %d expected %"PRIu64" found %"PRIu64"\n", fen, depth, expected, found);
+            fails++;
+        }
+    }
+
+    __atomic_fetch_add(&job->tested, tested, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&job->fails, fails, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&job->nodes, nodes, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+void initPerftTable(PerftTable *table, uint64_t megabytes) {
+
+    // Use the largest power of two number of entries within the megabytes
+    uint64_t entries = 1ull;
+    while (2 * entries * sizeof(PerftEntry) <= megabytes * MB) entries *= 2;
+
+    table->entries  = calloc(entries, sizeof(PerftEntry));
+    table->hashMask = entries - 1;
+}
+
+void freePerftTable(PerftTable *table) {
+    free(table->entries);
+}
+
+uint64_t perft(Board *board, int depth) {
+
+    Undo undo[1];
+    int size = 0;
+    uint64_t found = 0ull;
+    uint16_t moves[MAX_MOVES];
+
+    if (depth == 0) return 1ull;
+
+    // Call genAllNoisyMoves() & genAllQuietMoves()
+    size += genAllNoisyMoves(board, moves);
+    size += genAllQuietMoves(board, moves + size);
+
+    // Only legal moves are generated, so the final ply may be counted in bulk
+    if (depth == 1) return size;
+
+    // Recurse on all moves, which are always legal
+    for(size -= 1; size >= 0; size--) {
+        applyMove(board, moves[size], undo);
+        found += perft(board, depth-1);
+        revertMove(board, moves[size], undo);
+    }
+
+    return found;
+}
+
+uint64_t perftHashed(PerftTable *table, Board *board, int depth) {
+
+    Undo undo[1];
+    uint16_t moves[MAX_MOVES];
+    uint64_t key, found = 0ull;
+    PerftEntry *entry;
+
+    // Hashing is of no use when we would count moves in bulk anyway
+    if (depth <= 1) return perft(board, depth);
+
+    // Entries store their key xor'ed with the count, so that an entry torn
+    // apart by two threads writing at once never matches the probing key
+    key   = board->hash ^ (depth * PerftDepthMultiplier);
+    entry = &table->entries[key & table->hashMask];
+    if ((entry->check ^ entry->nodes) == key) return entry->nodes;
+
+    int size = genAllLegalMoves(board, moves);
+
+    for (int i = 0; i < size; i++) {
+        applyMove(board, moves[i], undo);
+        found += perftHashed(table, board, depth-1);
+        revertMove(board, moves[i], undo);
+    }
+
+    entry->check = key ^ found;
+    entry->nodes = found;
+    return found;
+}
+
+uint64_t perftParallel(PerftTable *table, Board *board, int depth, int nthreads) {
+
+    PerftRootJob job = { .table = table, .board = board, .depth = depth };
+
+    // Nothing to split unless the root moves still need to be searched
+    if (depth <= 1) return perft(board, depth);
+
+    pthread_t *pthreads = malloc(sizeof(pthread_t) * nthreads);
+    job.size = genAllLegalMoves(board, job.moves);
+
+    for (int i = 0; i < nthreads; i++)
+        pthread_create(&pthreads[i], NULL, &perftRootWorker, &job);
+
+    for (int i = 0; i < nthreads; i++)
+        pthread_join(pthreads[i], NULL);
+
+    free(pthreads);
+    return job.nodes;
+}
+
+void perftSuite(const char *fname, int maxDepth, int nthreads) {
+
+    char line[512];
+    int capacity = 1024;
+    PerftTable table;
+    PerftSuiteJob job = { .table = &table, .maxDepth = maxDepth };
+    pthread_t *pthreads = malloc(sizeof(pthread_t) * nthreads);
+    FILE *fin = fopen(fname, "r");
+
+    if (fin == NULL) {
+        printf("info string unable to open %s\n", fname);
+        free(pthreads); fflush(stdout); return;
+    }
+
+    // Read the entire suite up front, so threads may pull positions freely
+    job.lines = malloc(sizeof(char*) * capacity);
+    while (fgets(line, sizeof(line), fin) != NULL) {
+        if (job.count == capacity)
+            job.lines = realloc(job.lines, sizeof(char*) * (capacity *= 2));
+        job.lines[job.count++] = strdup(line);
+    }
+
+    fclose(fin);
+    initPerftTable(&table, PERFT_HASH_MB);
+
+    double start = getRealTime();
+
+    for (int i = 0; i < nthreads; i++)
+        pthread_create(&pthreads[i], NULL, &perftSuiteWorker, &job);
+
+    for (int i = 0; i < nthreads; i++)
+        pthread_join(pthreads[i], NULL);
+
+    double elapsed = (getRealTime() - start) / 1000.0;
+
+    printf("perftsuite %s: %d positions, %d fails, %"PRIu64" nodes, %.2fs, %.2f Mnps\n",
+        fname, job.tested, job.fails, job.nodes, elapsed, job.nodes / (elapsed + 1e-9) / 1e6);
+    fflush(stdout);
+
+    for (int i = 0; i < job.count; i++) free(job.lines[i]);
+    free(job.lines); free(pthreads);
+    freePerftTable(&table);
+}
@@ -67,6 +67,7 @@ void getBestMove(Thread *threads, Board *board, Limits *limits, uint16_t *best,
         return;
 
     // Minor house keeping for starting a search
+    allocateTT(); // Deferred until the first search
     updateTT(); // Table has an age component
     ABORT_SIGNAL = 0; // Otherwise Threads will exit
     initTimeManagment(&info, limits);
@@ -236,9 +237,16 @@ int search(Thread *thread, PVariation *pv, int alpha, int beta, int depth, int h
         // material. Add variance to the draw score, to avoid blindness to 3-fold lines
         if (boardIsDrawn(board, height)) return 1 - (thread->nodes & 2);
 
+        // Upcoming Repetition Detection. If we can reach a prior position with a
+        // single reversible move, then a draw score is a lower bound for this node
+        if (alpha < 0 && boardHasUpcomingRepetition(board, height)) {
+            alpha = 1 - (thread->nodes & 2);
+            if (alpha >= beta) return alpha;
+        }
+
         // Check to see if we have exceeded the maxiumum search draft
         if (height >= MAX_PLY)
-            return evaluateBoard(board, &thread->pktable, thread->contempt);
+            return evaluateBoard(thread, board);
 
         // Mate Distance Pruning. Check to see if this line is so
         // good, or so bad, that being mated in the ply, or  mating in
@@ -268,7 +276,7 @@ int search(Thread *thread, PVariation *pv, int alpha, int beta, int depth, int h
     // Step 5. Probe the Syzygy Tablebases. tablebasesProbeWDL() handles all of
     // the conditions about the board, the existance of tables, the probe depth,
     // as well as to not probe at the Root. The return is defined by the Fathom API
-    if ((tbresult = tablebasesProbeWDL(board, depth, height)) != TB_RESULT_FAILED) {
+    if ((tbresult = tablebasesProbeWDL(thread, board, depth, height)) != TB_RESULT_FAILED) {
 
         thread->tbhits++; // Increment tbhits counter for this thread
 
@@ -303,7 +311,7 @@ int search(Thread *thread, PVariation *pv, int alpha, int beta, int depth, int h
     // can recompute the eval as `eval = -last_eval + 2 * Tempo`
     eval = thread->evalStack[height] =
            ttHit && ttEval != VALUE_NONE            ?  ttEval
-         : thread->moveStack[height-1] != NULL_MOVE ?  evaluateBoard(board, &thread->pktable, thread->contempt)
+         : thread->moveStack[height-1] != NULL_MOVE ?  evaluateBoard(thread, board)
                                                     : -thread->evalStack[height-1] + 2 * Tempo;
 
     // Futility Pruning Margin
@@ -369,8 +377,8 @@ int search(Thread *thread, PVariation *pv, int alpha, int beta, int depth, int h
         initNoisyMovePicker(&movePicker, thread, rBeta - eval);
         while ((move = selectNextMove(&movePicker, board, 1)) != NONE_MOVE) {
 
-            // Apply move, skip if move is illegal
-            if (!apply(thread, board, move, height)) continue;
+            // Apply move, which the Move Picker has verified is legal
+            apply(thread, board, move, height);
 
             // For high depths, verify the move first with a depth one search
             if (depth >= 2 * ProbCutDepth)
@@ -452,12 +460,11 @@ int search(Thread *thread, PVariation *pv, int alpha, int beta, int depth, int h
         if (    best > -MATE_IN_MAX
             &&  depth <= SEEPruningDepth
             &&  movePicker.stage > STAGE_GOOD_NOISY
-            && !staticExchangeEvaluation(board, move, seeMargin[isQuiet]))
+            && !staticExchangeEvaluation(board, &movePicker.see, move, seeMargin[isQuiet]))
             continue;
 
-        // Apply move, skip if move is illegal
-        if (!apply(thread, board, move, height))
-            continue;
+        // Apply move, which the Move Picker has verified is legal
+        apply(thread, board, move, height);
 
         played += 1;
         if (isQuiet)
@@ -616,10 +623,17 @@ int qsearch(Thread *thread, PVariation *pv, int alpha, int beta, int height) {
     // material. Add variance to the draw score, to avoid blindness to 3-fold lines
     if (boardIsDrawn(board, height)) return 1 - (thread->nodes & 2);
 
+    // Upcoming Repetition Detection. If we can reach a prior position with a
+    // single reversible move, then a draw score is a lower bound for this node
+    if (alpha < 0 && boardHasUpcomingRepetition(board, height)) {
+        alpha = 1 - (thread->nodes & 2);
+        if (alpha >= beta) return alpha;
+    }
+
     // Step 3. Max Draft Cutoff. If we are at the maximum search draft,
     // then end the search here with a static eval of the current board
     if (height >= MAX_PLY)
-        return evaluateBoard(board, &thread->pktable, thread->contempt);
+        return evaluateBoard(thread, board);
 
     // Step 4. Probe the Transposition Table, adjust the value, and consider cutoffs
     if ((ttHit = getTTEntry(board->hash, &ttMove, &ttValue, &ttEval, &ttDepth, &ttBound))) {
@@ -635,10 +649,11 @@ int qsearch(Thread *thread, PVariation *pv, int alpha, int beta, int height) {
 
     // Save a history of the static evaluations. We can reuse a TT entry if the given
     // evaluation has been set. Also, if we made a NULL move on the previous ply, we
-    // can recompute the eval as `eval = -last_eval + 2 * Tempo`
+    // can recompute the eval as `eval = -last_eval + 2 * Tempo`. Otherwise, we only
+    // need to know how the eval compares to our window, so a lazy eval will suffice
     eval = thread->evalStack[height] =
            ttHit && ttEval != VALUE_NONE            ?  ttEval
-         : thread->moveStack[height-1] != NULL_MOVE ?  evaluateBoard(board, &thread->pktable, thread->contempt)
+         : thread->moveStack[height-1] != NULL_MOVE ?  evaluateBoardLazy(thread, board, alpha, beta)
                                                     : -thread->evalStack[height-1] + 2 * Tempo;
 
     // Step 5. Eval Pruning. If a static evaluation of the board will
@@ -660,8 +675,8 @@ int qsearch(Thread *thread, PVariation *pv, int alpha, int beta, int height) {
     initNoisyMovePicker(&movePicker, thread, MAX(QSEEMargin, margin));
     while ((move = selectNextMove(&movePicker, board, 1)) != NONE_MOVE) {
 
-        // Search the next ply if the move is legal
-        if (!apply(thread, board, move, height)) continue;
+        // Search the next ply, as the Move Picker only returns legal moves
+        apply(thread, board, move, height);
         value = -qsearch(thread, &lpv, -beta, -alpha, height+1);
         revert(thread, board, move, height);
 
@@ -688,7 +703,15 @@ int qsearch(Thread *thread, PVariation *pv, int alpha, int beta, int height) {
     return best;
 }
 
-int staticExchangeEvaluation(Board *board, uint16_t move, int threshold) {
+void initSEEContext(SEEContext *see, Board *board) {
+
+    // Grab sliders for updating revealed attackers
+    see->bishops  = board->pieces[BISHOP] | board->pieces[QUEEN];
+    see->rooks    = board->pieces[ROOK  ] | board->pieces[QUEEN];
+    see->occupied = board->colours[WHITE] | board->colours[BLACK];
+}
+
+int staticExchangeEvaluation(Board *board, SEEContext *see, uint16_t move, int threshold) {
 
     int from, to, type, colour, balance, nextVictim;
     uint64_t bishops, rooks, occupied, attackers, myAttackers;
@@ -719,12 +742,11 @@ int staticExchangeEvaluation(Board *board, uint16_t move, int threshold) {
     if (balance >= 0) return 1;
 
     // Grab sliders for updating revealed attackers
-    bishops = board->pieces[BISHOP] | board->pieces[QUEEN];
-    rooks   = board->pieces[ROOK  ] | board->pieces[QUEEN];
+    bishops = see->bishops;
+    rooks   = see->rooks;
 
     // Let occupied suppose that the move was actually made
-    occupied = (board->colours[WHITE] | board->colours[BLACK]);
-    occupied = (occupied ^ (1ull << from)) | (1ull << to);
+    occupied = (see->occupied ^ (1ull << from)) | (1ull << to);
     if (type == ENPASS_MOVE) occupied ^= (1ull << board->epSquare);
 
     // Get all pieces which attack the target square. And with occupied
@@ -802,7 +824,7 @@ int singularity(Thread *thread, MovePicker *mp, int ttValue, int depth, int beta
         assert(move != mp->tableMove); // Skip the table move
 
         // Perform a reduced depth search on a null rbeta window
-        if (!apply(thread, board, move, mp->height)) continue;
+        apply(thread, board, move, mp->height);
         value = -search(thread, &lpv, -rBeta-1, -rBeta, depth / 2 - 1, mp->height+1);
         revert(thread, board, move, mp->height);
 
@@ -825,7 +847,7 @@ int singularity(Thread *thread, MovePicker *mp, int ttValue, int depth, int beta
     }
 
     // Reapply the table move we took off
-    applyLegal(thread, board, mp->tableMove, mp->height);
+    apply(thread, board, mp->tableMove, mp->height);
 
     // Move is singular if all other moves failed low
     return value <= rBeta;
@@ -29,6 +29,10 @@ struct SearchInfo {
     int pvFactor;
 };
 
+struct SEEContext {
+    uint64_t bishops, rooks, occupied;
+};
+
 struct PVariation {
     uint16_t line[MAX_PLY];
     int length;
@@ -40,7 +44,8 @@ void* iterativeDeepening(void *vthread);
 void aspirationWindow(Thread *thread);
 int search(Thread *thread, PVariation *pv, int alpha, int beta, int depth, int height);
 int qsearch(Thread *thread, PVariation *pv, int alpha, int beta, int height);
-int staticExchangeEvaluation(Board *board, uint16_t move, int threshold);
+void initSEEContext(SEEContext *see, Board *board);
+int staticExchangeEvaluation(Board *board, SEEContext *see, uint16_t move, int threshold);
 int singularity(Thread *thread, MovePicker *mp, int ttValue, int depth, int beta);
 
 static const int WindowDepth   = 5;
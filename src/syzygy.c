@@ -18,20 +18,83 @@
 
 #include <assert.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 #include "bitboards.h"
 #include "board.h"
 #include "fathom/tbprobe.h"
 #include "move.h"
 #include "movegen.h"
+#include "thread.h"
 #include "types.h"
 #include "uci.h"
 
 unsigned TB_PROBE_DEPTH;    // Set by UCI options
+unsigned TB_PRELOAD;        // Set by UCI options
+int TB_PRELOAD_LOCK;        // Set by UCI options
+int TB_STATISTICS;          // Set by the Benchmark, to time each probe
 extern unsigned TB_LARGEST; // Set by Fathom in tb_init()
 
-unsigned tablebasesProbeWDL(Board *board, int depth, int height) {
+// WDL results shared by all Threads. Each entry is a single word, holding the
+// hash with its three low bits replaced by the result plus one, so that entries
+// are read and written without locks, and a zero word is an empty entry
+static uint64_t *WDLCache;
+static uint64_t WDLCacheMask;
+
+// The SyzygyPath and SyzygyIndex options, which may arrive in either order
+static char SyzygyPath[4096], SyzygyIndex[4096];
+
+static uint64_t nanoTime() {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return 1000000000ull * ts.tv_sec + ts.tv_nsec;
+}
+
+void initTablebaseCache(uint64_t megabytes) {
+
+    // Cleanup memory when resizing the cache
+    free(WDLCache);
+    WDLCache = NULL, WDLCacheMask = 0ull;
+
+    if (megabytes == 0) return; // Disabled
+
+    // Find the largest power of two number of entries within our megabytes
+    uint64_t entries = 8;
+    while (entries * 2 * sizeof(uint64_t) <= megabytes << 20) entries *= 2;
+
+    WDLCache     = calloc(entries, sizeof(uint64_t));
+    WDLCacheMask = entries - 1;
+}
+
+void tablebasesPreload() {
+
+    // Nothing is mapped until the first probe of each table, so the first
+    // probes of a new ending would otherwise wait on the disk mid-search.
+    // A cardinality of zero still releases any earlier locked tables
+    if (TB_LARGEST > 0) tb_preload(TB_PRELOAD, TB_PRELOAD_LOCK);
+}
+
+void tablebasesInit(const char *path, const char *index) {
+
+    // Either may be NULL, keeping the value from an earlier call
+    if (path  != NULL) snprintf(SyzygyPath, sizeof(SyzygyPath), "%s", path);
+    if (index != NULL) snprintf(SyzygyIndex, sizeof(SyzygyIndex), "%s", index);
+
+    // Nothing to do until we are given a path to search
+    if (!SyzygyPath[0]) return;
+
+    // The index is only trusted while each directory is unmodified
+    tb_init_index(SyzygyPath, strEquals(SyzygyIndex, "<empty>") ? NULL : SyzygyIndex);
+    if (TB_PRELOAD) tablebasesPreload();
+}
+
+unsigned tablebasesProbeWDL(Thread *thread, Board *board, int depth, int height) {
+
+    uint64_t entry, start;
+    unsigned result;
 
     // The basic rules for Syzygy assume that the last move was a zero'ing move,
     // there are no potential castling moves, and there is not an enpass square.
@@ -53,19 +116,46 @@ unsigned tablebasesProbeWDL(Board *board, int depth, int height) {
         || (cardinality == (int)TB_LARGEST && depth < (int)TB_PROBE_DEPTH))
         return TB_RESULT_FAILED;
 
+    // The same endings are probed again and again, by every Thread and at
+    // every iteration, so we first look for a result from an earlier probe
+    if (WDLCache != NULL) {
+
+        entry = __atomic_load_n(&WDLCache[board->hash & WDLCacheMask], __ATOMIC_RELAXED);
+
+        if (entry && (entry & ~0x7ull) == (board->hash & ~0x7ull)) {
+            if (thread != NULL) thread->tbcacheHits++;
+            return (unsigned) (entry & 0x7ull) - 1;
+        }
+    }
+
     // Tap into Fathom's API, which takes in the board representation, followed
     // by the half-move counter, the castling rights, the enpass square, and the
     // side to move. We verify that the half-move and the castle rights are zero
     // before calling. Additionally, a position with no potential enpass is set
     // as 0 in Fathom but -1 in Ethereal. Fathom sets WHITE=1 and BLACK=0.
 
-    return tb_probe_wdl(
+    start = TB_STATISTICS ? nanoTime() : 0ull;
+
+    result = tb_probe_wdl(
         board->colours[WHITE], board->colours[BLACK],
         board->pieces[KING  ], board->pieces[QUEEN ],
         board->pieces[ROOK  ], board->pieces[BISHOP],
         board->pieces[KNIGHT], board->pieces[PAWN  ],
         0, 0, 0, board->turn == WHITE ? 1 : 0
     );
+
+    if (thread != NULL)
+        thread->tbprobes++;
+
+    if (thread != NULL && TB_STATISTICS)
+        thread->tbprobeNanos += nanoTime() - start;
+
+    // Failures are not cached, as they depend on which tables are loaded
+    if (WDLCache != NULL && result != TB_RESULT_FAILED)
+        __atomic_store_n(&WDLCache[board->hash & WDLCacheMask],
+                         (board->hash & ~0x7ull) | (result + 1), __ATOMIC_RELAXED);
+
+    return result;
 }
 
 int tablebasesProbeDTZ(Board *board, uint16_t *best, uint16_t *ponder) {
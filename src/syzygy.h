@@ -22,5 +22,8 @@
 
 #include <stdint.h>
 
+void initTablebaseCache(uint64_t megabytes);
+void tablebasesInit(const char *path, const char *index);
+void tablebasesPreload();
 int tablebasesProbeDTZ(Board *board, uint16_t *best, uint16_t *ponder);
-unsigned tablebasesProbeWDL(Board *board, int depth, int height);
+unsigned tablebasesProbeWDL(Thread *thread, Board *board, int depth, int height);
@@ -221,7 +221,7 @@ void initTexelEntries(TexelEntry *tes, Thread *thread) {
 
         // Vectorize the evaluation coefficients
         T = EmptyTrace;
-        evaluateBoard(&thread->board, NULL, 0);
+        evaluateBoard(NULL, &thread->board);
         initCoefficients(coeffs);
 
         // Count up the non zero coefficients
@@ -22,6 +22,7 @@
 #include "board.h"
 #include "evaluate.h"
 #include "history.h"
+#include "nnue.h"
 #include "search.h"
 #include "thread.h"
 #include "transposition.h"
@@ -31,6 +32,10 @@
 int ContemptDrawPenalty = 0;
 int ContemptComplexity  = 0;
 
+// Default sizes of each Thread's Evaluation Cache and Pawn King Table, in megabytes
+int EvalCacheMB = 1;
+int PKTableMB   = 1;
+
 Thread* createThreadPool(int nthreads) {
 
     Thread *threads = malloc(sizeof(Thread) * nthreads);
@@ -47,6 +52,15 @@ Thread* createThreadPool(int nthreads) {
         memset(&threads[i]._moveStack, 0, sizeof(uint16_t) * STACK_SIZE);
         memset(&threads[i]._pieceStack, 0, sizeof(int) * STACK_SIZE);
 
+        // Each Board tracks its hash history in its Thread
+        threads[i].board.history = threads[i].keyStack;
+
+        // Each Thread has its own evaluation caches. Full evaluations are
+        // cached under the Thread's contempt, which is reset to zero here
+        initEvalCache(&threads[i].evalCache, EvalCacheMB);
+        initPKTable(&threads[i].pktable, PKTableMB);
+        threads[i].contempt = 0;
+
         // Threads will know of each other
         threads[i].index = i;
         threads[i].threads = threads;
@@ -58,6 +72,17 @@ Thread* createThreadPool(int nthreads) {
     return threads;
 }
 
+void deleteThreadPool(Thread *threads) {
+
+    // Release the per-thread heap allocations, and then the pool itself
+    for (int i = 0; i < threads->nthreads; i++) {
+        freeEvalCache(&threads[i].evalCache);
+        freePKTable(&threads[i].pktable);
+    }
+
+    free(threads);
+}
+
 void resetThreadPool(Thread *threads) {
 
     // Reset the per-thread tables, used for move ordering
@@ -65,7 +90,9 @@ void resetThreadPool(Thread *threads) {
     // calls in order to ensure a deterministic behaviour
 
     for (int i = 0; i < threads->nthreads; i++) {
-        memset(&threads[i].pktable, 0, sizeof(PKTable));
+        clearPKTable(&threads[i].pktable);
+        memset(&threads[i].mtable, 0, sizeof(MaterialTable));
+        clearEvalCache(&threads[i].evalCache);
         memset(&threads[i].killers, 0, sizeof(KillerTable));
         memset(&threads[i].cmtable, 0, sizeof(CounterMoveTable));
         memset(&threads[i].history, 0, sizeof(HistoryTable));
@@ -78,16 +105,30 @@ void newSearchThreadPool(Thread *threads, Board *board, Limits *limits, SearchIn
     // Initialize each Thread in the Thread Pool. We need a reference
     // to the UCI seach parameters, access to the timing information,
     // somewhere to store the results of each iteration by the main, and
-    // our own copy of the board. Also, we reset the seach statistics
+    // our own copy of the board. Also, we reset the seach statistics.
+    // The Board only points at its key stack, so we copy over the keys
+    // played since the last irreversible move and then repoint the Board.
+    // Cached evaluations include the contempt, so a change voids them.
+    // When using NNUE, the Board gets the Thread's stack of accumulators,
+    // and the accumulator for the root is computed from scratch
 
     int contempt = MakeScore(ContemptDrawPenalty + ContemptComplexity, ContemptDrawPenalty);
 
     for (int i = 0; i < threads->nthreads; i++) {
         threads[i].limits = limits;
         threads[i].info = info;
-        threads[i].nodes = threads[i].tbhits = 0ull;
+        threads[i].nodes = threads[i].tbhits = threads[i].kpkProbes = 0ull;
+        threads[i].tbcacheHits = threads[i].tbprobes = threads[i].tbprobeNanos = 0ull;
         memcpy(&threads[i].board, board, sizeof(Board));
+        threads[i].board.history = threads[i].keyStack;
+        for (int j = 0; j < board->numMoves; j++)
+            threads[i].keyStack[j] = board->history[j];
+        if (threads[i].contempt != (board->turn == WHITE ? contempt : -contempt))
+            clearEvalCache(&threads[i].evalCache);
         threads[i].contempt = board->turn == WHITE ? contempt : -contempt;
+        threads[i].board.accumulator = nnueEnabled() ? threads[i].nnueStack : NULL;
+        if (threads[i].board.accumulator != NULL)
+            nnueRefreshAccumulator(&threads[i].board);
     }
 }
 
@@ -116,3 +157,17 @@ uint64_t tbhitsThreadPool(Thread *threads) {
 
     return tbhits;
 }
+
+void tbstatsThreadPool(Thread *threads, uint64_t *cacheHits, uint64_t *probes, uint64_t *nanos) {
+
+    // Sum up the WDL Cache hits, and the count and duration of the
+    // probes which went through to Fathom, across each Thread
+
+    *cacheHits = *probes = *nanos = 0ull;
+
+    for (int i = 0; i < threads->nthreads; i++) {
+        *cacheHits += threads[i].tbcacheHits;
+        *probes    += threads[i].tbprobes;
+        *nanos     += threads[i].tbprobeNanos;
+    }
+}
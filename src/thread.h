@@ -22,6 +22,7 @@
 #include <stdint.h>
 
 #include "board.h"
+#include "nnue.h"
 #include "search.h"
 #include "transposition.h"
 #include "types.h"
@@ -45,14 +46,19 @@ struct Thread {
 
     int contempt;
     int depth, seldepth;
-    uint64_t nodes, tbhits;
+    uint64_t nodes, tbhits, kpkProbes;
+    uint64_t tbcacheHits, tbprobes, tbprobeNanos;
 
     int *evalStack, _evalStack[STACK_SIZE];
     uint16_t *moveStack, _moveStack[STACK_SIZE];
     int *pieceStack, _pieceStack[STACK_SIZE];
     Undo undoStack[STACK_SIZE];
+    uint64_t keyStack[KEY_STACK_SIZE];
+    NNUEAccumulator nnueStack[STACK_SIZE];
 
     PKTable pktable;
+    MaterialTable mtable;
+    EvalCache evalCache;
     KillerTable killers;
     CounterMoveTable cmtable;
     HistoryTable history;
@@ -65,7 +71,9 @@ struct Thread {
 
 
 Thread* createThreadPool(int nthreads);
+void deleteThreadPool(Thread *threads);
 void resetThreadPool(Thread *threads);
 void newSearchThreadPool(Thread *threads, Board *board, Limits *limits, SearchInfo *info);
 uint64_t nodesSearchedThreadPool(Thread *threads);
 uint64_t tbhitsThreadPool(Thread *threads);
+void tbstatsThreadPool(Thread *threads, uint64_t *cacheHits, uint64_t *probes, uint64_t *nanos);
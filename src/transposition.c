@@ -31,10 +31,7 @@
 TTable Table; // Global Transposition Table
 static const uint64_t MB = 1ull << 20;
 
-void initTT(uint64_t megabytes) {
-
-    // Cleanup memory when resizing the table
-    if (Table.hashMask) free(Table.buckets);
+static uint64_t keySizeTT(uint64_t megabytes) {
 
     // Use a default keysize of 16 bits, which should be equal to
     // the smallest possible hash table size, which is 2 megabytes
@@ -45,6 +42,28 @@ void initTT(uint64_t megabytes) {
     while ((1ull << keySize) * sizeof(TTBucket) <= megabytes * MB / 2) keySize++;
     assert((1ull << keySize) * sizeof(TTBucket) <= megabytes * MB);
 
+    return keySize;
+}
+
+void initTT(uint64_t megabytes) {
+
+    // Cleanup memory when resizing the table
+    if (Table.buckets) free(Table.buckets);
+
+    // Short lived processes may never search, and Hash is often set
+    // more than once, so the allocation waits until the Table is needed
+    Table.buckets   = NULL;
+    Table.hashMask  = 0ull;
+    Table.megabytes = megabytes;
+}
+
+void allocateTT() {
+
+    // Nothing to do when the Table is already in use
+    if (Table.buckets) return;
+
+    uint64_t keySize = keySizeTT(Table.megabytes);
+
 #if defined(__linux__) && !defined(__ANDROID__)
     // On Linux systems we align on 2MB boundaries and request Huge Pages
     Table.buckets = aligned_alloc(2 * MB, (1ull << keySize) * sizeof(TTBucket));
@@ -61,7 +80,7 @@ void initTT(uint64_t megabytes) {
 }
 
 int hashSizeMBTT() {
-    return ((Table.hashMask + 1) * sizeof(TTBucket)) / MB;
+    return ((1ull << keySizeTT(Table.megabytes)) * sizeof(TTBucket)) / MB;
 }
 
 void updateTT() {
@@ -80,6 +99,8 @@ void clearTT() {
     // Wipe the Table in preperation for a new game. The
     // Hash Mask is known to be one less than the size
 
+    if (Table.buckets == NULL) return; // Not yet allocated
+
     memset(Table.buckets, 0, sizeof(TTBucket) * (Table.hashMask + 1u));
 }
 
@@ -183,14 +204,101 @@ void storeTTEntry(uint64_t hash, uint16_t move, int value, int eval, int depth,
     replace->hash16     = (uint16_t)hash16;
 }
 
+void initPKTable(PKTable *pktable, uint64_t megabytes) {
+
+    // Use the largest power of two number of buckets within the megabytes.
+    // A size of zero disables the table, and evaluateBoard() skips it
+    uint64_t buckets = megabytes ? 1ull : 0ull;
+    while (buckets && 2 * buckets * sizeof(PKBucket) <= megabytes * MB) buckets *= 2;
+
+    pktable->buckets  = buckets ? calloc(buckets, sizeof(PKBucket)) : NULL;
+    pktable->hashMask = buckets ? buckets - 1 : 0ull;
+}
+
+void freePKTable(PKTable *pktable) {
+    free(pktable->buckets);
+    pktable->buckets = NULL;
+}
+
+void clearPKTable(PKTable *pktable) {
+    if (pktable->buckets != NULL)
+        memset(pktable->buckets, 0, sizeof(PKBucket) * (pktable->hashMask + 1));
+}
+
 PKEntry* getPKEntry(PKTable *pktable, uint64_t pkhash) {
-    PKEntry *pkentry = &pktable->entries[pkhash >> PKT_HASH_SHIFT];
-    return pkentry->pkhash == pkhash ? pkentry : NULL;
+
+    // The lower bits select the bucket, and the upper bits verify the entry
+    PKBucket *bucket = &pktable->buckets[pkhash & pktable->hashMask];
+    const uint32_t check = pkhash >> 32;
+
+    for (int i = 0; i < PKT_BUCKET_NB; i++)
+        if (bucket->slots[i].check == check)
+            return &bucket->slots[i];
+
+    return NULL;
 }
 
 void storePKEntry(PKTable *pktable, uint64_t pkhash, uint64_t passed, int eval) {
-    PKEntry *pkentry = &pktable->entries[pkhash >> PKT_HASH_SHIFT];
-    pkentry->pkhash = pkhash;
-    pkentry->passed = passed;
-    pkentry->eval   = eval;
+
+    PKBucket *bucket = &pktable->buckets[pkhash & pktable->hashMask];
+    const uint32_t check = pkhash >> 32;
+
+    // The newest entry always goes first, pushing the older one back
+    // unless the older one is for this same pawn and king structure
+    if (bucket->slots[0].check != check)
+        bucket->slots[1] = bucket->slots[0];
+
+    bucket->slots[0].passed = passed;
+    bucket->slots[0].check  = check;
+    bucket->slots[0].eval   = eval;
+}
+
+static uint64_t materialIndex(uint64_t key) {
+
+    // Material keys are exact counts rather than random, so mix them first
+    return (key * 0x9E3779B97F4A7C15ull) >> MT_HASH_SHIFT;
+}
+
+MaterialEntry* getMaterialEntry(MaterialTable *mtable, uint64_t key) {
+    MaterialEntry *mentry = &mtable->entries[materialIndex(key)];
+    return mentry->key == key ? mentry : NULL;
+}
+
+void storeMaterialEntry(MaterialTable *mtable, MaterialEntry *mentry) {
+    mtable->entries[materialIndex(mentry->key)] = *mentry;
+}
+
+void initEvalCache(EvalCache *cache, uint64_t megabytes) {
+
+    // Use the largest power of two number of entries within the megabytes.
+    // A size of zero disables the cache, and evaluateBoard() skips it
+    uint64_t entries = megabytes ? 1ull : 0ull;
+    while (entries && 2 * entries * sizeof(uint64_t) <= megabytes * MB) entries *= 2;
+
+    cache->entries  = entries ? calloc(entries, sizeof(uint64_t)) : NULL;
+    cache->hashMask = entries ? entries - 1 : 0ull;
+}
+
+void freeEvalCache(EvalCache *cache) {
+    free(cache->entries);
+    cache->entries = NULL;
+}
+
+void clearEvalCache(EvalCache *cache) {
+    if (cache->entries != NULL)
+        memset(cache->entries, 0, sizeof(uint64_t) * (cache->hashMask + 1));
+}
+
+int getEvalCacheEntry(EvalCache *cache, uint64_t hash, int *eval) {
+
+    // Entries pack the upper 48 bits of the hash with a 16 bit evaluation
+    uint64_t entry = cache->entries[hash & cache->hashMask];
+    if ((entry ^ hash) >> 16) return 0;
+
+    *eval = (int16_t)(entry & 0xFFFF);
+    return 1;
+}
+
+void storeEvalCacheEntry(EvalCache *cache, uint64_t hash, int eval) {
+    cache->entries[hash & cache->hashMask] = (hash & ~0xFFFFull) | (uint16_t)eval;
 }
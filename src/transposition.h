@@ -36,9 +36,13 @@ enum {
 };
 
 enum {
-    PKT_KEY_SIZE   = 16,
-    PKT_SIZE       = 1 << PKT_KEY_SIZE,
-    PKT_HASH_SHIFT = 64 - PKT_KEY_SIZE
+    PKT_BUCKET_NB = 2,
+};
+
+enum {
+    MT_KEY_SIZE   = 12,
+    MT_SIZE       = 1 << MT_KEY_SIZE,
+    MT_HASH_SHIFT = 64 - MT_KEY_SIZE
 };
 
 struct TTEntry {
@@ -56,20 +60,43 @@ struct TTBucket {
 struct TTable {
     TTBucket *buckets;
     uint64_t hashMask;
+    uint64_t megabytes;
     uint8_t generation;
 };
 
 struct PKEntry {
-    uint64_t pkhash;
     uint64_t passed;
-    int eval;
+    uint32_t check;
+    int32_t eval;
+};
+
+struct PKBucket {
+    PKEntry slots[PKT_BUCKET_NB];
 };
 
 struct PKTable {
-    PKEntry entries[PKT_SIZE];
+    PKBucket *buckets;
+    uint64_t hashMask;
+};
+
+struct MaterialEntry {
+    uint64_t key;
+    int16_t phase;
+    uint8_t scale[COLOUR_NB];
+    uint8_t endgame;
+};
+
+struct MaterialTable {
+    MaterialEntry entries[MT_SIZE];
+};
+
+struct EvalCache {
+    uint64_t *entries;
+    uint64_t hashMask;
 };
 
 void initTT(uint64_t megabytes);
+void allocateTT();
 int hashSizeMBTT();
 void updateTT();
 void clearTT();
@@ -80,5 +107,17 @@ void prefetchTTEntry(uint64_t hash);
 int getTTEntry(uint64_t hash, uint16_t *move, int *value, int *eval, int *depth, int *bound);
 void storeTTEntry(uint64_t hash, uint16_t move, int value, int eval, int depth, int bound);
 
+void initPKTable(PKTable *pktable, uint64_t megabytes);
+void freePKTable(PKTable *pktable);
+void clearPKTable(PKTable *pktable);
 PKEntry* getPKEntry(PKTable *pktable, uint64_t pkhash);
 void storePKEntry(PKTable *pktable, uint64_t pkhash, uint64_t passed, int eval);
+
+MaterialEntry* getMaterialEntry(MaterialTable *mtable, uint64_t key);
+void storeMaterialEntry(MaterialTable *mtable, MaterialEntry *mentry);
+
+void initEvalCache(EvalCache *cache, uint64_t megabytes);
+void freeEvalCache(EvalCache *cache);
+void clearEvalCache(EvalCache *cache);
+int getEvalCacheEntry(EvalCache *cache, uint64_t hash, int *eval);
+void storeEvalCacheEntry(EvalCache *cache, uint64_t hash, int eval);
@@ -76,11 +76,14 @@ static inline int makePiece(int type, int colour) {
 // Forward definition of all structs
 
 typedef struct Magic Magic;
+typedef struct SliderBackend SliderBackend;
 typedef struct Board Board;
 typedef struct Undo Undo;
+typedef struct CheckInfo CheckInfo;
 typedef struct EvalTrace EvalTrace;
 typedef struct EvalInfo EvalInfo;
 typedef struct MovePicker MovePicker;
+typedef struct SEEContext SEEContext;
 typedef struct SearchInfo SearchInfo;
 typedef struct PVariation PVariation;
 typedef struct Thread Thread;
@@ -88,9 +91,19 @@ typedef struct TTEntry TTEntry;
 typedef struct TTBucket TTBucket;
 typedef struct TTable TTable;
 typedef struct PKEntry PKEntry;
+typedef struct PKBucket PKBucket;
 typedef struct PKTable PKTable;
+typedef struct MaterialEntry MaterialEntry;
+typedef struct MaterialTable MaterialTable;
+typedef struct EvalCache EvalCache;
+typedef struct PerftEntry PerftEntry;
+typedef struct PerftTable PerftTable;
+typedef struct NNUENetwork NNUENetwork;
+typedef struct NNUEAccumulator NNUEAccumulator;
+typedef struct Endgame Endgame;
 typedef struct Limits Limits;
 typedef struct UCIGoStruct UCIGoStruct;
+typedef struct StartupPhase StartupPhase;
 
 // Renamings, currently for move ordering
 
@@ -22,17 +22,24 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "attacks.h"
+#include "bitbase.h"
 #include "board.h"
 #include "cmdline.h"
+#include "cpu.h"
+#include "endgame.h"
 #include "evaluate.h"
 #include "fathom/tbprobe.h"
 #include "history.h"
 #include "masks.h"
 #include "move.h"
 #include "movegen.h"
+#include "nnue.h"
+#include "perft.h"
 #include "search.h"
+#include "syzygy.h"
 #include "texel.h"
 #include "thread.h"
 #include "time.h"
@@ -43,29 +50,62 @@
 
 extern int ContemptDrawPenalty;   // Defined by Thread.c
 extern int ContemptComplexity;    // Defined by Thread.c
+extern int EvalCacheMB;           // Defined by Thread.c
+extern int PKTableMB;             // Defined by Thread.c
 extern int MoveOverhead;          // Defined by Time.c
 extern unsigned TB_PROBE_DEPTH;   // Defined by Syzygy.c
+extern unsigned TB_PRELOAD;       // Defined by Syzygy.c
+extern int TB_PRELOAD_LOCK;       // Defined by Syzygy.c
+extern int UseNNUE;               // Defined by NNUE.c
 extern volatile int ABORT_SIGNAL; // Defined by Search.c
 extern volatile int IS_PONDERING; // Defined by Search.c
 
 pthread_mutex_t READYLOCK = PTHREAD_MUTEX_INITIALIZER;
 const char *StartPosition = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 
+StartupPhase StartupPhases[STARTUP_PHASE_NB]; // Reported by ./Ethereal startup
+int StartupPhaseCount;
+
+static void timeStartupPhase(const char *name, double *phaseClock) {
+
+    // getRealTime() only has a resolution of milliseconds
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+
+    double now = 1e3 * ts.tv_sec + ts.tv_nsec / 1e6;
+    if (name != NULL) StartupPhases[StartupPhaseCount++] = (StartupPhase) { name, now - *phaseClock };
+    *phaseClock = now;
+}
+
 int main(int argc, char **argv) {
 
     Board board;
     char str[8192];
+    uint64_t keyStack[KEY_STACK_SIZE];
     Thread *threads;
     pthread_t pthreadsgo;
     UCIGoStruct uciGoStruct;
 
     int chess960 = 0;
     int multiPV  = 1;
-
-    // Initialize core components of Ethereal
-    initAttacks(); initMasks(); initEval();
-    initSearch(); initZobrist(); initTT(16);
-    threads = createThreadPool(1);
+    double phaseClock;
+
+    // Initialize core components of Ethereal, timing each phase. The Table is
+    // only sized here, and allocated once we are ready or start searching
+    timeStartupPhase(NULL, &phaseClock);
+    initCPU();                     timeStartupPhase("initCPU", &phaseClock);
+    initAttacks();                 timeStartupPhase("initAttacks", &phaseClock);
+    initMasks();                   timeStartupPhase("initMasks", &phaseClock);
+    initEval();                    timeStartupPhase("initEval", &phaseClock);
+    initSearch();                  timeStartupPhase("initSearch", &phaseClock);
+    initZobrist();                 timeStartupPhase("initZobrist", &phaseClock);
+    initBitbases();                timeStartupPhase("initBitbases", &phaseClock);
+    initEndgames();                timeStartupPhase("initEndgames", &phaseClock);
+    initCuckoo();                  timeStartupPhase("initCuckoo", &phaseClock);
+    initTT(16);                    timeStartupPhase("initTT", &phaseClock);
+    initTablebaseCache(1);         timeStartupPhase("initTablebaseCache", &phaseClock);
+    threads = createThreadPool(1); timeStartupPhase("createThreadPool", &phaseClock);
+    board.history = keyStack;
     boardFromFEN(&board, StartPosition, chess960);
 
     // Handle any command line requests
@@ -74,23 +114,32 @@ int main(int argc, char **argv) {
     while (getInput(str)) {
 
         if (strEquals(str, "uci")) {
-            printf("id name Ethereal " ETHEREAL_VERSION "\n");
+            if (cpuPathName() == NULL) printf("id name Ethereal " ETHEREAL_VERSION "\n");
+            else printf("id name Ethereal " ETHEREAL_VERSION " (%s)\n", cpuPathName());
             printf("id author Andrew Grant, Alayan & Laldon\n");
             printf("option name Hash type spin default 16 min 2 max 65536\n");
             printf("option name Threads type spin default 1 min 1 max 2048\n");
             printf("option name MultiPV type spin default 1 min 1 max 256\n");
+            printf("option name EvalCache type spin default 1 min 0 max 1024\n");
+            printf("option name PawnHash type spin default 1 min 0 max 1024\n");
             printf("option name ContemptDrawPenalty type spin default 0 min -300 max 300\n");
             printf("option name ContemptComplexity type spin default 0 min -100 max 100\n");
             printf("option name MoveOverhead type spin default 100 min 0 max 10000\n");
+            printf("option name SyzygyIndex type string default <empty>\n");
             printf("option name SyzygyPath type string default <empty>\n");
             printf("option name SyzygyProbeDepth type spin default 0 min 0 max 127\n");
+            printf("option name SyzygyCache type spin default 1 min 0 max 1024\n");
+            printf("option name SyzygyPreload type spin default 0 min 0 max 7\n");
+            printf("option name SyzygyPreloadLock type check default false\n");
+            printf("option name EvalFile type string default <empty>\n");
+            printf("option name UseNNUE type check default false\n");
             printf("option name Ponder type check default false\n");
             printf("option name UCI_Chess960 type check default false\n");
             printf("uciok\n"), fflush(stdout);
         }
 
         else if (strEquals(str, "isready"))
-            printf("readyok\n"), fflush(stdout);
+            allocateTT(), printf("readyok\n"), fflush(stdout);
 
         else if (strEquals(str, "ucinewgame"))
             resetThreadPool(threads), clearTT();
@@ -120,8 +169,11 @@ int main(int argc, char **argv) {
         else if (strEquals(str, "quit"))
             break;
 
+        else if (strStartsWith(str, "perftsuite"))
+            uciPerftSuite(str, threads->nthreads);
+
         else if (strStartsWith(str, "perft"))
-            printf("%"PRIu64"\n", perft(&board, atoi(str + strlen("perft ")))), fflush(stdout);
+            uciPerft(str, &board, threads->nthreads);
 
         else if (strStartsWith(str, "print"))
             printBoard(&board), fflush(stdout);
@@ -231,11 +283,19 @@ void uciSetOption(char *str, Thread **threads, int *multiPV, int *chess960) {
     //  Hash                : Size of the Transposition Table in Megabyes
     //  Threads             : Number of search threads to use
     //  MultiPV             : Number of search lines to report per iteration
+    //  EvalCache           : Size of each Thread's Evaluation Cache in Megabytes
+    //  PawnHash            : Size of each Thread's Pawn King Table in Megabytes
     //  ContemptDrawPenalty : Evaluation bonus in internal units to avoid forced draws
     //  ContemptComplexity  : Evaluation bonus for keeping a position with more non-pawn material
     //  MoveOverhead        : Overhead on time allocation to avoid time losses
+    //  SyzygyIndex         : File caching the Tablebases found in the SyzygyPath
     //  SyzygyPath          : Path to Syzygy Tablebases
     //  SyzygyProbeDepth    : Minimal Depth to probe the highest cardinality Tablebase
+    //  SyzygyCache         : Size of the shared cache of Tablebase WDL results in Megabytes
+    //  SyzygyPreload       : Read WDL Tables with up to this many pieces into memory up front
+    //  SyzygyPreloadLock   : Lock the preloaded WDL Tables in memory with mlock()
+    //  EvalFile            : Path to an NNUE Network file
+    //  UseNNUE             : Evaluate with the loaded NNUE Network instead of the classical eval
     //  UCI_Chess960        : Set when playing FRC, but not required in order to work
 
     if (strStartsWith(str, "setoption name Hash value ")) {
@@ -245,10 +305,24 @@ void uciSetOption(char *str, Thread **threads, int *multiPV, int *chess960) {
 
     if (strStartsWith(str, "setoption name Threads value ")) {
         int nthreads = atoi(str + strlen("setoption name Threads value "));
-        free(*threads); *threads = createThreadPool(nthreads);
+        deleteThreadPool(*threads); *threads = createThreadPool(nthreads);
         printf("info string set Threads to %d\n", nthreads);
     }
 
+    if (strStartsWith(str, "setoption name EvalCache value ")) {
+        int nthreads = (*threads)->nthreads;
+        EvalCacheMB = atoi(str + strlen("setoption name EvalCache value "));
+        deleteThreadPool(*threads); *threads = createThreadPool(nthreads);
+        printf("info string set EvalCache to %dMB\n", EvalCacheMB);
+    }
+
+    if (strStartsWith(str, "setoption name PawnHash value ")) {
+        int nthreads = (*threads)->nthreads;
+        PKTableMB = atoi(str + strlen("setoption name PawnHash value "));
+        deleteThreadPool(*threads); *threads = createThreadPool(nthreads);
+        printf("info string set PawnHash to %dMB\n", PKTableMB);
+    }
+
     if (strStartsWith(str, "setoption name MultiPV value ")) {
         *multiPV = atoi(str + strlen("setoption name MultiPV value "));
         printf("info string set MultiPV to %d\n", *multiPV);
@@ -271,7 +345,12 @@ void uciSetOption(char *str, Thread **threads, int *multiPV, int *chess960) {
 
     if (strStartsWith(str, "setoption name SyzygyPath value ")) {
         char *ptr = str + strlen("setoption name SyzygyPath value ");
-        tb_init(ptr); printf("info string set SyzygyPath to %s\n", ptr);
+        tablebasesInit(ptr, NULL); printf("info string set SyzygyPath to %s\n", ptr);
+    }
+
+    if (strStartsWith(str, "setoption name SyzygyIndex value ")) {
+        char *ptr = str + strlen("setoption name SyzygyIndex value ");
+        tablebasesInit(NULL, ptr); printf("info string set SyzygyIndex to %s\n", ptr);
     }
 
     if (strStartsWith(str, "setoption name SyzygyProbeDepth value ")) {
@@ -279,6 +358,38 @@ void uciSetOption(char *str, Thread **threads, int *multiPV, int *chess960) {
         printf("info string set SyzygyProbeDepth to %u\n", TB_PROBE_DEPTH);
     }
 
+    if (strStartsWith(str, "setoption name SyzygyCache value ")) {
+        int megabytes = atoi(str + strlen("setoption name SyzygyCache value "));
+        initTablebaseCache(megabytes); printf("info string set SyzygyCache to %dMB\n", megabytes);
+    }
+
+    if (strStartsWith(str, "setoption name SyzygyPreload value ")) {
+        TB_PRELOAD = atoi(str + strlen("setoption name SyzygyPreload value "));
+        printf("info string set SyzygyPreload to %u\n", TB_PRELOAD);
+        tablebasesPreload();
+    }
+
+    if (strStartsWith(str, "setoption name SyzygyPreloadLock value ")) {
+        TB_PRELOAD_LOCK = strStartsWith(str, "setoption name SyzygyPreloadLock value true");
+        printf("info string set SyzygyPreloadLock to %s\n", TB_PRELOAD_LOCK ? "true" : "false");
+        if (TB_PRELOAD) tablebasesPreload();
+    }
+
+    if (strStartsWith(str, "setoption name EvalFile value ")) {
+        char *ptr = str + strlen("setoption name EvalFile value ");
+        if (strEquals(ptr, "<empty>")) nnueFree(), printf("info string unloaded EvalFile\n");
+        else if (nnueInit(ptr)) printf("info string set EvalFile to %s\n", ptr);
+        else printf("info string failed to load EvalFile %s\n", ptr);
+        clearTT(); resetThreadPool(*threads); // Void evaluations cached by the old evaluator
+    }
+
+    if (strStartsWith(str, "setoption name UseNNUE value ")) {
+        UseNNUE = strStartsWith(str, "setoption name UseNNUE value true");
+        printf("info string set UseNNUE to %s\n", UseNNUE ? "true" : "false");
+        if (UseNNUE && cpuNNUEHint() != NULL) printf("info string %s\n", cpuNNUEHint());
+        clearTT(); resetThreadPool(*threads); // Void evaluations cached by the old evaluator
+    }
+
     if (strStartsWith(str, "setoption name UCI_Chess960 value ")) {
         if (strStartsWith(str, "setoption name UCI_Chess960 value true"))
             printf("info string set UCI_Chess960 to true\n"), *chess960 = 1;
@@ -331,7 +442,7 @@ void uciPosition(char *str, Board *board, int chess960) {
 
         // Reset move history whenever we reset the fifty move rule. This way
         // we can track all positions that are candidates for repetitions, and
-        // are still able to use a fixed size for the history array (512)
+        // are still able to use a fixed size for the key stack (KEY_STACK_SIZE)
         if (board->halfMoveCounter == 0)
             board->numMoves = 0;
 
@@ -340,6 +451,27 @@ void uciPosition(char *str, Board *board, int chess960) {
     }
 }
 
+void uciPerft(char *str, Board *board, int nthreads) {
+
+    // perft <depth> : count leaves, splitting root moves among the threads
+    PerftTable table;
+    int depth = atoi(str + strlen("perft "));
+
+    initPerftTable(&table, PERFT_HASH_MB);
+    printf("%"PRIu64"\n", perftParallel(&table, board, depth, nthreads));
+    fflush(stdout);
+    freePerftTable(&table);
+}
+
+void uciPerftSuite(char *str, int nthreads) {
+
+    // perftsuite <epd> [depth] : verify an EPD suite, no deeper than depth
+    char fname[512]; int depth = MAX_PLY;
+
+    if (sscanf(str, "perftsuite %511s %d", fname, &depth) >= 1)
+        perftSuite(fname, depth, nthreads);
+}
+
 void uciReport(Thread *threads, int alpha, int beta, int value) {
 
     // Gather all of the statistics that the UCI protocol would be
@@ -24,13 +24,9 @@
 
 #define VERSION_ID "12.21"
 
-#if defined(USE_PEXT)
-    #define ETHEREAL_VERSION VERSION_ID" (PEXT)"
-#elif defined(USE_POPCNT)
-    #define ETHEREAL_VERSION VERSION_ID" (POPCNT)"
-#else
-    #define ETHEREAL_VERSION VERSION_ID
-#endif
+// The build, or the CPU when using USE_DISPATCH, adds the path taken
+// for slider indexing and bit counting. See cpuPathName() in CPU.c
+#define ETHEREAL_VERSION VERSION_ID
 
 struct Limits {
     double start, time, inc, mtg, timeLimit;
@@ -46,9 +42,16 @@ struct UCIGoStruct {
     Thread *threads;
 };
 
+struct StartupPhase {
+    const char *name;
+    double elapsed; // Milliseconds
+};
+
 void *uciGo(void *cargo);
 void uciSetOption(char *str, Thread **threads, int *multiPV, int *chess960);
 void uciPosition(char *str, Board *board, int chess960);
+void uciPerft(char *str, Board *board, int nthreads);
+void uciPerftSuite(char *str, int nthreads);
 
 void uciReport(Thread *threads, int alpha, int beta, int value);
 void uciReportTBRoot(Board *board, uint16_t move, unsigned wdl, unsigned dtz);
@@ -58,3 +61,8 @@ int strEquals(char *str1, char *str2);
 int strStartsWith(char *str, char *key);
 int strContains(char *str, char *key);
 int getInput(char *str);
+
+enum { STARTUP_PHASE_NB = 16 };
+
+extern StartupPhase StartupPhases[STARTUP_PHASE_NB];
+extern int StartupPhaseCount;
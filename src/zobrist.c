@@ -16,8 +16,12 @@
   along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <assert.h>
 #include <stdint.h>
 
+#include "attacks.h"
+#include "bitboards.h"
+#include "move.h"
 #include "types.h"
 #include "zobrist.h"
 
@@ -26,6 +30,11 @@ uint64_t ZobristEnpassKeys[FILE_NB];
 uint64_t ZobristCastleKeys[SQUARE_NB];
 uint64_t ZobristTurnKey;
 
+uint64_t MaterialKeys[32][SQUARE_NB];
+
+uint64_t CuckooKeys[CUCKOO_SIZE];
+uint16_t CuckooMoves[CUCKOO_SIZE];
+
 uint64_t rand64() {
 
     // http://vigna.di.unimi.it/ftp/papers/xorshift.pdf
@@ -57,4 +66,72 @@ void initZobrist() {
 
     // Init the Zobrist key for side to move
     ZobristTurnKey = rand64();
+
+    // Material keys are not random. Each piece adds one to a four bit counter
+    // for its colour and type, with Bishops counted per square colour, so the
+    // sum is the exact material signature. Kings ensure it is never zero
+    for (int piece = PAWN; piece <= KING; piece++)
+        for (int sq = 0; sq < SQUARE_NB; sq++)
+            for (int colour = WHITE; colour <= BLACK; colour++) {
+                int field = colour * 7 + piece + (piece > BISHOP)
+                          + (piece == BISHOP && testBit(WHITE_SQUARES, sq));
+                MaterialKeys[makePiece(piece, colour)][sq] = 1ull << (4 * field);
+            }
+}
+
+void initCuckoo() {
+
+    // Build a Cuckoo hash table of every reversible move, which is any move
+    // made by a non-Pawn piece between two squares on an empty board. The key
+    // of each move is the difference it makes to the Zobrist hash of a position.
+    // See https://marcelk.net/2013-04-06/paper/upcoming-rep-v2.pdf for details
+
+    int count = 0;
+
+    for (int piece = KNIGHT; piece <= KING; piece++) {
+        for (int colour = WHITE; colour <= BLACK; colour++) {
+            for (int sq1 = 0; sq1 < SQUARE_NB; sq1++) {
+                for (int sq2 = sq1 + 1; sq2 < SQUARE_NB; sq2++) {
+
+                    uint64_t attacks = piece == KNIGHT ? knightAttacks(sq1)
+                                     : piece == BISHOP ? bishopAttacks(sq1, 0ull)
+                                     : piece == ROOK   ? rookAttacks(sq1, 0ull)
+                                     : piece == QUEEN  ? queenAttacks(sq1, 0ull)
+                                     :                   kingAttacks(sq1);
+
+                    if (!testBit(attacks, sq2)) continue;
+
+                    uint16_t move = MoveMake(sq1, sq2, NORMAL_MOVE);
+                    uint64_t key  = ZobristKeys[makePiece(piece, colour)][sq1]
+                                  ^ ZobristKeys[makePiece(piece, colour)][sq2]
+                                  ^ ZobristTurnKey;
+
+                    // Insert the move, bouncing the occupant of the slot over to its
+                    // alternate slot, until we have found an empty slot in the table
+                    for (int slot = cuckooIndex1(key); move != NONE_MOVE; ) {
+
+                        uint64_t tempKey  = CuckooKeys[slot];
+                        uint16_t tempMove = CuckooMoves[slot];
+
+                        CuckooKeys[slot]  = key;  key  = tempKey;
+                        CuckooMoves[slot] = move; move = tempMove;
+
+                        slot = slot == cuckooIndex1(key) ? cuckooIndex2(key) : cuckooIndex1(key);
+                    }
+
+                    count++;
+                }
+            }
+        }
+    }
+
+    assert(count == 3668); (void) count;
+}
+
+int cuckooIndex1(uint64_t key) {
+    return key & (CUCKOO_SIZE - 1);
+}
+
+int cuckooIndex2(uint64_t key) {
+    return (key >> 16) & (CUCKOO_SIZE - 1);
 }
@@ -22,10 +22,21 @@
 
 #include "types.h"
 
+enum { CUCKOO_SIZE = 8192 };
+
 extern uint64_t ZobristKeys[32][SQUARE_NB];
 extern uint64_t ZobristEnpassKeys[FILE_NB];
 extern uint64_t ZobristCastleKeys[SQUARE_NB];
 extern uint64_t ZobristTurnKey;
 
+extern uint64_t MaterialKeys[32][SQUARE_NB];
+
+extern uint64_t CuckooKeys[CUCKOO_SIZE];
+extern uint16_t CuckooMoves[CUCKOO_SIZE];
+
 uint64_t rand64();
 void initZobrist();
+void initCuckoo();
+
+int cuckooIndex1(uint64_t key);
+int cuckooIndex2(uint64_t key);